@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    AudioHandoff.h
+    Lock-free single-producer/single-consumer audio FIFO between two stages of
+    the pipeline, one stage writes while the next one reads.
+
+    It starts out holding 'delay' samples of silence and every call writes as
+    many samples as the reader takes, so the reader always gets audio the
+    writer finished on an earlier call and the delay stays constant whatever
+    the block sizes. Built on juce::AbstractFifo, storage allocated in prepare().
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ProjectAudio
+{
+    class AudioHandoff
+    {
+    public:
+        /** Blocks up to 'delay' samples, one block may be in flight on each side. */
+        void prepare(int numChannels, int delaySamples)
+        {
+            delay = juce::jmax(0, delaySamples);
+
+            const auto size = delay * 2 + 1; //the delay, one block written ahead of the read, the slot AbstractFifo keeps free
+            buffer.setSize(numChannels, size);
+            fifo.setTotalSize(size);
+            reset();
+        }
+
+        /** Neither side may run: back to 'delay' samples of silence. */
+        void reset()
+        {
+            fifo.reset();
+            buffer.clear();
+            fifo.finishedWrite(delay);
+        }
+
+        int getDelay() const noexcept { return delay; }
+
+        /** Producer thread. */
+        void write(const juce::dsp::AudioBlock<float>& block)
+        {
+            const auto numSamples = static_cast<int>(block.getNumSamples());
+            jassert(numSamples <= fifo.getFreeSpace());
+
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+            for (size_t ch = 0; ch < block.getNumChannels() && ch < static_cast<size_t>(buffer.getNumChannels()); ++ch)
+            {
+                const auto* source = block.getChannelPointer(ch);
+                auto* store = buffer.getWritePointer(static_cast<int>(ch));
+
+                std::copy(source, source + size1, store + start1);
+                std::copy(source + size1, source + size1 + size2, store + start2);
+            }
+
+            fifo.finishedWrite(size1 + size2);
+        }
+
+        /** Consumer thread, fills the whole block from audio written at least 'delay' samples ago. */
+        void read(juce::dsp::AudioBlock<float>& block)
+        {
+            const auto numSamples = static_cast<int>(block.getNumSamples());
+            jassert(numSamples <= fifo.getNumReady());
+
+            int start1, size1, start2, size2;
+            fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+            for (size_t ch = 0; ch < block.getNumChannels() && ch < static_cast<size_t>(buffer.getNumChannels()); ++ch)
+            {
+                const auto* store = buffer.getReadPointer(static_cast<int>(ch));
+                auto* dest = block.getChannelPointer(ch);
+
+                std::copy(store + start1, store + start1 + size1, dest);
+                std::copy(store + start2, store + start2 + size2, dest + size1);
+            }
+
+            fifo.finishedRead(size1 + size2);
+        }
+
+    private:
+        juce::AbstractFifo fifo{ 1 };
+        juce::AudioBuffer<float> buffer;
+        int delay = 0;
+    };
+}
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    BandSplitter.h
+    Linkwitz-Riley crossover that splits a block into 2 - 4 bands whose sum
+    is an allpass of the input, the multiband layout of SimpleMultiBandComp.
+
+    Crossover k splits what is above crossover k - 1 into a low band and the
+    rest; every band below crossover k runs through crossover k's allpass
+    instead, so all bands share the same phase and add up flat. Filters are
+    juce::dsp::LinkwitzRileyFilter (4th order), allocated in prepare().
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ProjectAudio
+{
+    class BandSplitter
+    {
+    public:
+        static constexpr size_t maxBands = 4;
+        static constexpr size_t maxCrossovers = maxBands - 1;
+
+        using Crossovers = std::array<float, maxCrossovers>; //Hz, lowest first
+
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            sampleRate = spec.sampleRate;
+
+            for (size_t k = 0; k < maxCrossovers; ++k)
+            {
+                lowpass[k].prepare(spec);
+                lowpass[k].setType(juce::dsp::LinkwitzRileyFilterType::lowpass);
+                highpass[k].prepare(spec);
+                highpass[k].setType(juce::dsp::LinkwitzRileyFilterType::highpass);
+
+                for (auto& filter : allpass[k])
+                {
+                    filter.prepare(spec);
+                    filter.setType(juce::dsp::LinkwitzRileyFilterType::allpass);
+                }
+            }
+
+            applied.fill(0.f); //every cutoff is set again on the next setCrossovers
+            reset();
+        }
+
+        void reset()
+        {
+            for (size_t k = 0; k < maxCrossovers; ++k)
+            {
+                lowpass[k].reset();
+                highpass[k].reset();
+
+                for (auto& filter : allpass[k])
+                    filter.reset();
+            }
+        }
+
+        /** Audio thread, 1 passes the input through; a new count starts the filters from silence. */
+        void setNumBands(size_t newNumBands)
+        {
+            newNumBands = juce::jlimit<size_t>(1, maxBands, newNumBands);
+
+            if (newNumBands == numBands)
+                return;
+
+            numBands = newNumBands;
+            reset();
+        }
+
+        size_t getNumBands() const noexcept { return numBands; }
+
+        /** Audio thread: kept in ascending order and below Nyquist, a cutoff that did not move costs nothing. */
+        void setCrossovers(const Crossovers& hz)
+        {
+            const auto maxHz = static_cast<float>(sampleRate * 0.45);
+            auto floorHz = 20.f;
+
+            for (size_t k = 0; k < maxCrossovers; ++k)
+            {
+                const auto cutoff = juce::jlimit(floorHz, maxHz, hz[k]);
+                floorHz = cutoff; //a crossover below the one before it would fold a band inside out
+
+                if (cutoff == applied[k])
+                    continue;
+
+                applied[k] = cutoff;
+                lowpass[k].setCutoffFrequency(cutoff);
+                highpass[k].setCutoffFrequency(cutoff);
+
+                for (auto& filter : allpass[k])
+                    filter.setCutoffFrequency(cutoff);
+            }
+        }
+
+        /** The first getNumBands() blocks get the bands of 'input', lowest first, each the size of 'input'. */
+        void process(const juce::dsp::AudioBlock<float>& input, std::array<juce::dsp::AudioBlock<float>, maxBands>& bands)
+        {
+            auto& rest = bands[numBands - 1]; //what is above every crossover so far, the top band once they are all done
+            rest.copyFrom(input);
+
+            for (size_t k = 0; k + 1 < numBands; ++k)
+            {
+                bands[k].copyFrom(rest);
+                lowpass[k].process(juce::dsp::ProcessContextReplacing<float>(bands[k]));
+                highpass[k].process(juce::dsp::ProcessContextReplacing<float>(rest));
+
+                //the bands below keep in phase with the two this crossover made
+                for (size_t j = 0; j < k; ++j)
+                    allpass[k][j].process(juce::dsp::ProcessContextReplacing<float>(bands[j]));
+            }
+        }
+
+    private:
+        using Filter = juce::dsp::LinkwitzRileyFilter<float>;
+
+        std::array<Filter, maxCrossovers> lowpass, highpass;
+        std::array<std::array<Filter, maxBands - 2>, maxCrossovers> allpass; //[k][j]: band j below crossover k, j < k
+
+        Crossovers applied{};
+        size_t numBands = 1;
+        double sampleRate = 44100.0;
+    };
+}
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    BypassFader.h
+    Click-free bypass for one stage of the chain.
+
+    Fully bypassed: the stage is not processed and should not be updated.
+    Fully engaged:  the stage processes the block in place, nothing else.
+    In between:     the dry input is copied to preallocated scratch, the stage
+                    runs, and wet/dry are mixed with a linear per-sample ramp.
+
+    A stage with latency (oversampling, linear phase) keeps it when bypassed:
+    the dry path runs through a delay of the same length, so the host's
+    latency does not move on a toggle and the fade mixes signals in time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CompensationDelay.h"
+
+namespace ProjectAudio
+{
+    class BypassFader
+    {
+    public:
+        void prepare(const juce::dsp::ProcessSpec& spec, int maxLatencySamples = 0, double fadeSeconds = 0.01)
+        {
+            dry.setSize(static_cast<int>(spec.numChannels), static_cast<int>(spec.maximumBlockSize));
+            ramp.resize(spec.maximumBlockSize);
+            fadeStep = 1.f / static_cast<float>(juce::jmax(1.0, fadeSeconds * spec.sampleRate));
+            dryDelay.prepare(spec, maxLatencySamples);
+        }
+
+        /** Jumps to the state without a fade, for prepareToPlay. */
+        void snapTo(bool shouldBeEngaged)
+        {
+            engaged = shouldBeEngaged;
+            gain = engaged ? 1.f : 0.f;
+            dryDelay.reset();
+        }
+
+        /** Audio thread: the stage's latency, the dry path is delayed by the same amount. */
+        void setLatency(int latencySamples) { dryDelay.setDelay(latencySamples); }
+
+        /** Returns true when a fade-in starts from fully bypassed, the stage should be reset then. */
+        bool setEngaged(bool shouldBeEngaged)
+        {
+            if (shouldBeEngaged == engaged)
+                return false;
+
+            const auto wasAsleep = isFullyBypassed();
+            engaged = shouldBeEngaged;
+            return engaged && wasAsleep;
+        }
+
+        bool isFullyBypassed() const { return !engaged && gain == 0.f; }
+        bool isFullyEngaged() const { return engaged && gain == 1.f; }
+
+        /** Calls processWet(block) unless fully bypassed, crossfading while a fade is running. */
+        template <typename ProcessWet>
+        void process(juce::dsp::AudioBlock<float> block, ProcessWet&& processWet)
+        {
+            if (isFullyBypassed())
+            {
+                dryDelay.process(block); //in time with the stage it stands in for, free without latency
+                return;
+            }
+
+            if (isFullyEngaged())
+            {
+                dryDelay.push(block); //a fade-out later finds the dry path current
+                processWet(block);
+                return;
+            }
+
+            const auto numSamples = block.getNumSamples();
+            const auto numChannels = block.getNumChannels();
+            jassert(numSamples <= ramp.size() && numChannels <= static_cast<size_t>(dry.getNumChannels()));
+
+            auto dryBlock = juce::dsp::AudioBlock<float>(dry).getSubsetChannelBlock(0, numChannels).getSubBlock(0, numSamples);
+            dryBlock.copyFrom(block);
+            dryDelay.process(dryBlock);
+
+            processWet(block);
+
+            const auto step = engaged ? fadeStep : -fadeStep;
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                gain = juce::jlimit(0.f, 1.f, gain + step);
+                ramp[i] = gain;
+            }
+
+            //out = dry + (wet - dry) * ramp
+            using FVO = juce::FloatVectorOperations;
+            const auto n = static_cast<int>(numSamples);
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                auto* wet = block.getChannelPointer(ch);
+                FVO::subtract(wet, dryBlock.getChannelPointer(ch), n);
+                FVO::multiply(wet, ramp.data(), n);
+                FVO::add(wet, dryBlock.getChannelPointer(ch), n);
+            }
+        }
+
+    private:
+        juce::AudioBuffer<float> dry;
+        CompensationDelay dryDelay;
+        std::vector<float> ramp;
+        float fadeStep = 1.f;
+        float gain = 1.f;
+        bool engaged = true;
+    };
+}
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    ChainPermutations.h
+    Numbering of the orders of N stages, and a table with one entry per order
+    generated at compile time.
+
+    fromIndex / toIndex map between a permutation of 0 .. N-1 and its rank in
+    lexicographic order (factorial number system). makeTable calls
+    make.template operator()<order...>() for every rank, so a table of function
+    pointers to templates specialised on the order is built by the compiler
+    and a runtime order costs one lookup.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ProjectAudio::ChainPermutations
+{
+    constexpr size_t factorial(size_t n) { return n <= 1 ? 1 : n * factorial(n - 1); }
+
+    /** Permutation number 'index' of 0 .. N-1, lexicographic order. */
+    template <size_t N>
+    constexpr std::array<size_t, N> fromIndex(size_t index)
+    {
+        std::array<size_t, N> remaining{}, result{};
+
+        for (size_t i = 0; i < N; ++i)
+            remaining[i] = i;
+
+        for (size_t i = 0, count = N; i < N; ++i, --count)
+        {
+            const auto weight = factorial(N - 1 - i);
+            const auto pick = index / weight;
+            index %= weight;
+
+            result[i] = remaining[pick];
+
+            for (auto j = pick; j + 1 < count; ++j)
+                remaining[j] = remaining[j + 1];
+        }
+
+        return result;
+    }
+
+    /** Inverse of fromIndex, factorial(N) when 'order' is not a permutation of 0 .. N-1. */
+    template <typename T, size_t N>
+    constexpr size_t toIndex(const std::array<T, N>& order)
+    {
+        std::array<bool, N> used{};
+        size_t index = 0;
+
+        for (size_t i = 0; i < N; ++i)
+        {
+            const auto value = static_cast<size_t>(order[i]);
+
+            if (value >= N || used[value])
+                return factorial(N);
+
+            size_t rank = 0; //smaller values not used yet
+
+            for (size_t v = 0; v < value; ++v)
+                rank += used[v] ? 0 : 1;
+
+            index += rank * factorial(N - 1 - i);
+            used[value] = true;
+        }
+
+        return index;
+    }
+
+    namespace detail
+    {
+        template <size_t N, size_t Index, typename Make, size_t... Positions>
+        constexpr auto makeEntry(const Make& make, std::index_sequence<Positions...>)
+        {
+            constexpr auto order = fromIndex<N>(Index);
+            return make.template operator()<order[Positions]...>();
+        }
+
+        template <size_t N, typename Make, size_t... Indices>
+        constexpr auto makeTable(const Make& make, std::index_sequence<Indices...>)
+        {
+            return std::array{ makeEntry<N, Indices>(make, std::make_index_sequence<N>{})... };
+        }
+    }
+
+    /** table[i] = make.template operator()<fromIndex<N>(i)[0], ..., fromIndex<N>(i)[N - 1]>() */
+    template <size_t N, typename Make>
+    constexpr auto makeTable(const Make& make)
+    {
+        return detail::makeTable<N>(make, std::make_index_sequence<factorial(N)>{});
+    }
+}
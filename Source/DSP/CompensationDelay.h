@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    CompensationDelay.h
+    Whole-sample delay that lines a branch up with a longer one before the
+    branches are mixed, so oversampling and linear-phase latency do not comb.
+
+    The ring holds the longest delay plus one block and is allocated in
+    prepare(). Growing the delay zeroes the samples it exposes instead of
+    replaying old audio; a delay of 0 passes the block through untouched.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ProjectAudio
+{
+    class CompensationDelay
+    {
+    public:
+        void prepare(const juce::dsp::ProcessSpec& spec, int maxDelaySamples)
+        {
+            maxDelay = juce::jmax(0, maxDelaySamples);
+            ringSize = maxDelay + static_cast<int>(spec.maximumBlockSize);
+            ring.setSize(static_cast<int>(spec.numChannels), ringSize);
+            reset();
+        }
+
+        /** Audio thread: clears only what the current delay can read back. */
+        void reset()
+        {
+            clearBehindWriteHead(0, delay);
+        }
+
+        int getMaxDelay() const noexcept { return maxDelay; }
+
+        /** Audio thread, clamped to the prepared maximum. */
+        void setDelay(int newDelay)
+        {
+            newDelay = juce::jlimit(0, maxDelay, newDelay);
+
+            if (newDelay > delay)
+                clearBehindWriteHead(delay, newDelay); //never heard before, silence rather than stale audio
+
+            delay = newDelay;
+        }
+
+        void process(juce::dsp::AudioBlock<float> block)
+        {
+            if (delay == 0)
+                return; //in time already, skip the copy
+
+            const auto numSamples = static_cast<int>(block.getNumSamples());
+            const auto numChannels = juce::jmin(static_cast<int>(block.getNumChannels()), ring.getNumChannels());
+            jassert(numSamples <= ringSize - maxDelay);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* data = block.getChannelPointer(static_cast<size_t>(ch));
+                auto* store = ring.getWritePointer(ch);
+                auto readPos = writePos - delay;
+
+                if (readPos < 0)
+                    readPos += ringSize;
+
+                auto write = writePos;
+
+                for (int i = 0; i < numSamples; ++i)
+                {
+                    store[write] = data[i];
+                    data[i] = store[readPos];
+
+                    if (++write == ringSize) write = 0;
+                    if (++readPos == ringSize) readPos = 0;
+                }
+            }
+
+            writePos = (writePos + numSamples) % ringSize;
+        }
+
+        /** Records the block without delaying it, the ring stays current while nobody listens to the delayed copy. */
+        void push(const juce::dsp::AudioBlock<float>& block)
+        {
+            if (delay == 0)
+                return; //nothing to read back, setDelay clears what a longer delay exposes
+
+            const auto numSamples = static_cast<int>(block.getNumSamples());
+            const auto numChannels = juce::jmin(static_cast<int>(block.getNumChannels()), ring.getNumChannels());
+            jassert(numSamples <= ringSize - maxDelay);
+
+            const auto firstPart = juce::jmin(numSamples, ringSize - writePos);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                const auto* data = block.getChannelPointer(static_cast<size_t>(ch));
+                auto* store = ring.getWritePointer(ch);
+
+                std::copy(data, data + firstPart, store + writePos);
+                std::copy(data + firstPart, data + numSamples, store);
+            }
+
+            writePos = (writePos + numSamples) % ringSize;
+        }
+
+    private:
+        void clearBehindWriteHead(int from, int to) //samples writePos - to .. writePos - from
+        {
+            for (int ch = 0; ch < ring.getNumChannels(); ++ch)
+            {
+                auto* store = ring.getWritePointer(ch);
+
+                for (int i = from; i < to; ++i)
+                    store[(writePos - 1 - i + ringSize) % ringSize] = 0.f;
+            }
+        }
+
+        juce::AudioBuffer<float> ring;
+        int ringSize = 0, maxDelay = 0, delay = 0, writePos = 0;
+    };
+}
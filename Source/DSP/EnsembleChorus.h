@@ -0,0 +1,254 @@
+/*
+  ==============================================================================
+
+    EnsembleChorus.h
+    Chorus with 1 to 8 voices per channel reading one shared ring buffer.
+
+    Same controls and delay mapping as juce::dsp::Chorus:
+      delay = max(1 ms, centre + 10 ms * depth * lfo), lfo a sine per voice
+    Voices spread their LFOs evenly over one cycle and are averaged; the mix
+    of the voices is fed back into the ring. Stereo spread shifts the LFOs of
+    odd channels by up to half a cycle.
+
+    Voices sit in SIMD lanes: delay ramps, cubic Lagrange weights and the
+    weighted sum run on LaneRegisters, only the four taps per voice are
+    gathered from the ring one lane at a time. LFOs are evaluated once per
+    process() call (control rate) and the delays ramped per sample.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SIMDLaneProcessor.h"
+
+namespace ProjectAudio
+{
+    class EnsembleChorus
+    {
+    public:
+        static constexpr size_t maxVoices = 8;
+        static constexpr size_t numLanes = LaneRegister::SIMDNumElements;
+        static constexpr size_t numVoiceGroups = (maxVoices + numLanes - 1) / numLanes;
+
+        static constexpr float maxCentreDelayMs = 100.f;
+        static constexpr float maxModulationMs = 10.f; //20 ms * depth * 0.5 in juce::dsp::Chorus
+
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            sampleRate = static_cast<float>(spec.sampleRate);
+
+            //longest delay plus the taps after it, rounded up so wrapping is a mask
+            const auto maxDelaySamples = static_cast<size_t>(std::ceil((maxCentreDelayMs + maxModulationMs) * 0.001f * sampleRate)) + 4;
+            const auto ringSize = juce::nextPowerOfTwo(static_cast<int>(maxDelaySamples));
+
+            channels.resize(spec.numChannels);
+
+            for (auto& c : channels)
+                c.ring.resize(static_cast<size_t>(ringSize));
+
+            ringMask = static_cast<size_t>(ringSize) - 1;
+
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& c : channels)
+            {
+                std::fill(c.ring.begin(), c.ring.end(), 0.f);
+                c.writeIndex = 0;
+            }
+
+            lfoPhase = 0.f;
+            snapToNextTarget = true;
+        }
+
+        void setRate(float newRateHz) { rate = newRateHz; }
+        void setDepth(float newDepth) { depth = juce::jlimit(0.f, 1.f, newDepth); }
+        void setCentreDelay(float newDelayMs) { centreDelayMs = juce::jlimit(1.f, maxCentreDelayMs, newDelayMs); }
+        void setFeedback(float newFeedback) { targetFeedback = juce::jlimit(-0.99f, 0.99f, newFeedback); }
+        void setMix(float newMix) { targetMix = juce::jlimit(0.f, 1.f, newMix); }
+        void setNumVoices(size_t newNumVoices) { numVoices = juce::jlimit<size_t>(1, maxVoices, newNumVoices); }
+
+        /** 0..1, 1 runs the LFOs of odd channels half a cycle behind. */
+        void setStereoSpread(float newSpread) { spread = juce::jlimit(0.f, 1.f, newSpread); }
+
+        size_t getNumVoices() const { return numVoices; }
+
+        void process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+        {
+            if (context.isBypassed)
+                return; //replacing context, the output already holds the input
+
+            auto& block = context.getOutputBlock();
+            const auto numSamples = block.getNumSamples();
+            jassert(block.getNumChannels() <= channels.size());
+
+            if (numSamples == 0)
+                return;
+
+            //control rate: LFOs where this block ends
+            lfoPhase += rate * static_cast<float>(numSamples) / sampleRate;
+            lfoPhase -= std::floor(lfoPhase);
+
+            const auto inv = 1.f / static_cast<float>(numSamples);
+
+            if (snapToNextTarget)
+            {
+                feedback = targetFeedback;
+                mix = targetMix;
+            }
+
+            const auto feedbackStep = (targetFeedback - feedback) * inv;
+            const auto mixStep = (targetMix - mix) * inv;
+
+            for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+            {
+                auto& c = channels[ch];
+                const auto phaseOffset = (ch & 1) != 0 ? 0.5f * spread : 0.f;
+
+                std::array<LaneRegister, numVoiceGroups> delayStep, gainStep;
+
+                for (size_t g = 0; g < numVoiceGroups; ++g)
+                {
+                    const auto targetDelay = getDelaysInSamples(g, phaseOffset);
+                    const auto targetGain = getVoiceGains(g);
+
+                    if (snapToNextTarget)
+                    {
+                        c.delay[g] = targetDelay;
+                        c.gain[g] = targetGain;
+                    }
+
+                    delayStep[g] = (targetDelay - c.delay[g]) * inv;
+                    gainStep[g] = (targetGain - c.gain[g]) * inv;
+                }
+
+                processChannel(block.getChannelPointer(ch), numSamples, c, delayStep, gainStep, feedbackStep, mixStep);
+            }
+
+            snapToNextTarget = false;
+            feedback = targetFeedback;
+            mix = targetMix;
+        }
+
+    private:
+        struct Channel
+        {
+            std::vector<float> ring;
+            size_t writeIndex = 0;
+            std::array<LaneRegister, numVoiceGroups> delay{}, gain{}; //where the last block ended, in samples / linear
+        };
+
+        LaneRegister getDelaysInSamples(size_t group, float phaseOffset) const noexcept
+        {
+            LaneRegister result(0.f);
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+            {
+                const auto voice = group * numLanes + lane;
+                const auto voicePhase = lfoPhase + phaseOffset + static_cast<float>(voice) / static_cast<float>(numVoices);
+                const auto lfo = std::sin(juce::MathConstants<float>::twoPi * voicePhase);
+
+                const auto delayMs = juce::jmax(1.f, centreDelayMs + maxModulationMs * depth * lfo);
+                result.set(lane, delayMs * 0.001f * sampleRate);
+            }
+
+            return result;
+        }
+
+        LaneRegister getVoiceGains(size_t group) const noexcept
+        {
+            LaneRegister result(0.f);
+
+            for (size_t lane = 0; lane < numLanes; ++lane)
+                result.set(lane, group * numLanes + lane < numVoices ? 1.f / static_cast<float>(numVoices) : 0.f);
+
+            return result;
+        }
+
+        void processChannel(float* samples, size_t numSamples, Channel& c,
+                            const std::array<LaneRegister, numVoiceGroups>& delayStep,
+                            const std::array<LaneRegister, numVoiceGroups>& gainStep,
+                            float feedbackStep, float mixStep) noexcept
+        {
+            alignas(sizeof(LaneRegister)) float whole[numLanes];
+            alignas(sizeof(LaneRegister)) float taps[4][numLanes];
+
+            auto fb = feedback;
+            auto wetMix = mix;
+            auto delay = c.delay;
+            auto gain = c.gain;
+            auto* ring = c.ring.data();
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                fb += feedbackStep;
+                wetMix += mixStep;
+
+                auto sum = LaneRegister(0.f);
+
+                for (size_t g = 0; g < numVoiceGroups; ++g)
+                {
+                    delay[g] += delayStep[g];
+                    gain[g] += gainStep[g];
+
+                    const auto d = delay[g];
+                    const auto k = LaneRegister::truncate(d); //delays are >= 1 ms, never negative
+                    const auto t = d - k;
+                    k.copyToRawArray(whole);
+
+                    //taps at k - 1, k, k + 1, k + 2 samples ago
+                    for (size_t lane = 0; lane < numLanes; ++lane)
+                    {
+                        const auto base = c.writeIndex - static_cast<size_t>(whole[lane]);
+
+                        taps[0][lane] = ring[(base + 1) & ringMask];
+                        taps[1][lane] = ring[base & ringMask];
+                        taps[2][lane] = ring[(base - 1) & ringMask];
+                        taps[3][lane] = ring[(base - 2) & ringMask];
+                    }
+
+                    //cubic Lagrange through x = -1, 0, 1, 2 evaluated at t
+                    const auto tp1 = t + 1.f;
+                    const auto tm1 = t - 1.f;
+                    const auto tm2 = t - 2.f;
+
+                    const auto w0 = t * tm1 * tm2 * (-1.f / 6.f);
+                    const auto w1 = tp1 * tm1 * tm2 * 0.5f;
+                    const auto w2 = tp1 * t * tm2 * -0.5f;
+                    const auto w3 = tp1 * t * tm1 * (1.f / 6.f);
+
+                    const auto voices = w0 * LaneRegister::fromRawArray(taps[0]) + w1 * LaneRegister::fromRawArray(taps[1])
+                                      + w2 * LaneRegister::fromRawArray(taps[2]) + w3 * LaneRegister::fromRawArray(taps[3]);
+
+                    sum += voices * gain[g];
+                }
+
+                const auto x = samples[i];
+                const auto wet = sum.sum();
+
+                ring[c.writeIndex] = x + wet * fb;
+                c.writeIndex = (c.writeIndex + 1) & ringMask;
+
+                samples[i] = x * (1.f - wetMix) + wet * wetMix;
+            }
+
+            c.delay = delay;
+            c.gain = gain;
+        }
+
+        std::vector<Channel> channels;
+        size_t ringMask = 0;
+        size_t numVoices = 1;
+
+        float sampleRate = 44100.f;
+        float rate = 1.f, depth = 0.25f, centreDelayMs = 7.f, spread = 0.f;
+        float lfoPhase = 0.f;
+        float feedback = 0.f, targetFeedback = 0.f;
+        float mix = 0.5f, targetMix = 0.5f;
+        bool snapToNextTarget = true;
+    };
+}
@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+    FastMath.h
+    Bounded-error replacements for the transcendental calls in coefficient
+    updates.
+
+    tanPi(f / fs)     tan(pi * f / fs), relative error < 4e-7 on [0, 0.4995]
+    exp2              relative error < 2.5e-7 for results in the normal range
+    exp               exp2 plus the rounding of x * log2(e), < 4e-6 for |x| < 80
+    decibelsToGain    relative error < 1e-6 on (-100, 50] dB, 0 at or below -100 dB
+                      like juce::Decibels
+    tanh              absolute error < 3e-7, +-1 beyond |x| = 8
+
+    The tan table works on normalised frequency, so one constexpr table covers
+    every sample rate; callers keep 1 / fs from prepareToPlay.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <bit>
+
+namespace ProjectAudio::FastMath
+{
+    namespace detail
+    {
+        constexpr size_t tanTableSize = 128; //intervals over [0, pi/4]
+
+        /** Taylor series, only evaluated at compile time on [0, pi/4]. */
+        constexpr double constexprTan(double x)
+        {
+            double sinSum = 0.0, cosSum = 0.0;
+            double sinTerm = x, cosTerm = 1.0;
+
+            for (int n = 0; n < 20; ++n)
+            {
+                sinSum += sinTerm;
+                cosSum += cosTerm;
+                sinTerm *= -x * x / ((2.0 * n + 2.0) * (2.0 * n + 3.0));
+                cosTerm *= -x * x / ((2.0 * n + 1.0) * (2.0 * n + 2.0));
+            }
+
+            return sinSum / cosSum;
+        }
+
+        constexpr auto makeTanTable()
+        {
+            std::array<float, tanTableSize + 2> table{};
+
+            for (size_t i = 0; i < table.size(); ++i)
+                table[i] = static_cast<float>(constexprTan(juce::MathConstants<double>::pi * 0.25 * static_cast<double>(i) / tanTableSize));
+
+            return table;
+        }
+
+        inline constexpr auto tanTable = makeTanTable();
+
+        /** tan(x) for x in [0, pi/4], cubic Hermite with the exact slope 1 + tan^2. */
+        inline float tanQuarter(float x) noexcept
+        {
+            constexpr auto step = juce::MathConstants<float>::pi * 0.25f / static_cast<float>(tanTableSize);
+
+            const auto pos = x * (1.f / step);
+            const auto i = juce::jmin(static_cast<size_t>(pos), tanTableSize - 1);
+            const auto t = pos - static_cast<float>(i);
+
+            const auto y0 = tanTable[i];
+            const auto y1 = tanTable[i + 1];
+            const auto d0 = (1.f + y0 * y0) * step;
+            const auto d1 = (1.f + y1 * y1) * step;
+
+            const auto t2 = t * t;
+            const auto t3 = t2 * t;
+
+            return (2.f * t3 - 3.f * t2 + 1.f) * y0 + (t3 - 2.f * t2 + t) * d0
+                 + (3.f * t2 - 2.f * t3) * y1 + (t3 - t2) * d1;
+        }
+    }
+
+    namespace detail
+    {
+        constexpr size_t tanhTableSize = 128; //intervals over [0, 8]
+        constexpr float tanhTableEnd = 8.f;
+
+        /** e^x for |x| <= 16, Taylor on x / 32 then squared five times, compile time only. */
+        constexpr double constexprExp(double x)
+        {
+            const auto small = x / 32.0;
+            double sum = 0.0, term = 1.0;
+
+            for (int n = 1; n < 20; ++n)
+            {
+                sum += term;
+                term *= small / n;
+            }
+
+            for (int i = 0; i < 5; ++i)
+                sum *= sum;
+
+            return sum;
+        }
+
+        constexpr auto makeTanhTable()
+        {
+            std::array<float, tanhTableSize + 2> table{};
+
+            for (size_t i = 0; i < table.size(); ++i)
+            {
+                const auto e = constexprExp(2.0 * tanhTableEnd * static_cast<double>(i) / tanhTableSize);
+                table[i] = static_cast<float>((e - 1.0) / (e + 1.0));
+            }
+
+            return table;
+        }
+
+        inline constexpr auto tanhTable = makeTanhTable();
+    }
+
+    /** Cubic Hermite through the table with the exact slope 1 - tanh^2, odd symmetric. */
+    inline float tanh(float x) noexcept
+    {
+        constexpr auto step = detail::tanhTableEnd / static_cast<float>(detail::tanhTableSize);
+
+        const auto pos = juce::jmin(std::abs(x), detail::tanhTableEnd) * (1.f / step);
+        const auto i = juce::jmin(static_cast<size_t>(pos), detail::tanhTableSize - 1);
+        const auto t = pos - static_cast<float>(i);
+
+        const auto y0 = detail::tanhTable[i];
+        const auto y1 = detail::tanhTable[i + 1];
+        const auto d0 = (1.f - y0 * y0) * step;
+        const auto d1 = (1.f - y1 * y1) * step;
+
+        const auto t2 = t * t;
+        const auto t3 = t2 * t;
+
+        const auto y = (2.f * t3 - 3.f * t2 + 1.f) * y0 + (t3 - 2.f * t2 + t) * d0
+                     + (3.f * t2 - 2.f * t3) * y1 + (t3 - t2) * d1;
+
+        return std::copysign(std::abs(x) < detail::tanhTableEnd ? y : 1.f, x);
+    }
+
+    /** tan(pi * normalisedFreq), normalisedFreq = f / fs, clamped to [0, 0.4995]. */
+    inline float tanPi(float normalisedFreq) noexcept
+    {
+        const auto u = juce::jlimit(0.f, 0.4995f, normalisedFreq);
+
+        if (u <= 0.25f)
+            return detail::tanQuarter(u * juce::MathConstants<float>::pi);
+
+        //tan(x) = 1 / tan(pi/2 - x), 0.5 - u is exact in float
+        return 1.f / detail::tanQuarter((0.5f - u) * juce::MathConstants<float>::pi);
+    }
+
+    /** 2^x, degree 6 Taylor on the rounded fraction [-0.5, 0.5]. */
+    inline float exp2(float x) noexcept
+    {
+        x = juce::jlimit(-126.f, 127.f, x);
+
+        const auto n = std::nearbyint(x);
+        const auto f = x - n;
+
+        constexpr float c1 = 0.69314718056f, c2 = 0.24022650696f, c3 = 0.05550410866f,
+                        c4 = 0.00961812911f, c5 = 0.00133335581f, c6 = 0.00015403530f;
+
+        const auto p = 1.f + f * (c1 + f * (c2 + f * (c3 + f * (c4 + f * (c5 + f * c6)))));
+        const auto scale = std::bit_cast<float>(static_cast<juce::int32>(n + 127.f) << 23);
+
+        return p * scale;
+    }
+
+    inline float exp(float x) noexcept
+    {
+        constexpr auto log2e = 1.44269504089f;
+        return exp2(x * log2e);
+    }
+
+    inline float decibelsToGain(float decibels, float minusInfinityDb = -100.f) noexcept
+    {
+        constexpr auto log2Of10Over20 = 0.16609640474f;
+        return decibels > minusInfinityDb ? exp2(decibels * log2Of10Over20) : 0.f;
+    }
+}
@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    LanePhaser.h
+    Phaser with 4 to 12 first-order allpass stages, every lane a channel.
+
+    Same controls and mapping as juce::dsp::Phaser: a sine LFO moves the
+    allpass frequency around the centre on a log scale between 20 Hz and
+    min(20 kHz, 0.49 fs), the chain output is fed back and mixed with the dry
+    input. Lanes can run the LFO with a phase offset, odd channels get it, so
+    stereo blocks spread out.
+
+    The LFO and the allpass coefficient are evaluated once per process() call
+    (control rate) and ramped per sample across the block. The TPT allpass is
+    stable for any coefficient on the way, nothing needs a reset.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SIMDLaneProcessor.h"
+#include "FastMath.h"
+
+namespace ProjectAudio
+{
+    /** One channel of SampleType (float or LaneRegister), run by SIMDLaneProcessor. */
+    template <typename SampleType>
+    class LanePhaser
+    {
+    public:
+        using Traits = LaneTraits<SampleType>;
+
+        static constexpr size_t maxStages = 12;
+        static constexpr float minFrequency = 20.f;
+
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            jassert(spec.numChannels == 1);
+
+            sampleRate = static_cast<float>(spec.sampleRate);
+            maxFrequency = juce::jmin(20000.f, 0.49f * sampleRate);
+            log2Range = std::log2(maxFrequency / minFrequency);
+
+            snapToNextTarget = true;
+            reset();
+        }
+
+        void reset()
+        {
+            states.fill(SampleType(0.f));
+            lastOutput = SampleType(0.f);
+            lfoPhase = 0.f;
+            snapToNextTarget = true;
+        }
+
+        void setRate(float newRateHz) { rate = newRateHz; }
+        void setDepth(float newDepth) { depth = juce::jlimit(0.f, 1.f, newDepth); }
+        void setMix(float newMix) { targetMix = juce::jlimit(0.f, 1.f, newMix); }
+
+        void setCentreFrequency(float newCentreHz)
+        {
+            //normalised on the log axis like juce::dsp::Phaser, values under 20 Hz sit below 0
+            normCentre = std::log2(juce::jmax(newCentreHz, 1.0e-3f) / minFrequency) / log2Range;
+        }
+
+        /** Unity feedback around an allpass chain never decays, so it stops just short of it. */
+        void setFeedback(float newFeedback) { targetFeedback = juce::jlimit(-0.99f, 0.99f, newFeedback); }
+
+        /** 4, 6, 8 or 12, stages that join start from silence. */
+        void setNumStages(size_t newNumStages)
+        {
+            newNumStages = juce::jlimit<size_t>(1, maxStages, newNumStages);
+
+            for (auto s = numStages; s < newNumStages; ++s)
+                states[s] = SampleType(0.f);
+
+            numStages = newNumStages;
+        }
+
+        size_t getNumStages() const { return numStages; }
+
+        /** LFO offset of the odd channels in cycles, firstChannel is the channel in lane 0. */
+        void setStereoOffset(float offsetCycles, size_t firstChannel)
+        {
+            stereoOffset = offsetCycles;
+            firstLaneChannel = firstChannel;
+        }
+
+        template <typename ProcessContext>
+        void process(const ProcessContext& context) noexcept
+        {
+            const auto& inputBlock = context.getInputBlock();
+            auto& outputBlock = context.getOutputBlock();
+
+            jassert(inputBlock.getNumChannels() == 1 && outputBlock.getNumChannels() == 1);
+
+            const auto numSamples = outputBlock.getNumSamples();
+            const auto* in = inputBlock.getChannelPointer(0);
+            auto* out = outputBlock.getChannelPointer(0);
+
+            if (context.isBypassed)
+            {
+                if (in != out)
+                    std::copy(in, in + numSamples, out);
+
+                return;
+            }
+
+            if (numSamples == 0)
+                return;
+
+            //control rate: the LFO where this block ends, ramped to from where the last one ended
+            lfoPhase += rate * static_cast<float>(numSamples) / sampleRate;
+            lfoPhase -= std::floor(lfoPhase);
+
+            const auto target = getCoefficientAt(lfoPhase);
+
+            if (snapToNextTarget)
+            {
+                coefficient = target;
+                feedback = targetFeedback;
+                mix = targetMix;
+                snapToNextTarget = false;
+            }
+
+            const auto inv = 1.f / static_cast<float>(numSamples);
+            const auto coefficientStep = (target - coefficient) * inv;
+            const auto feedbackStep = (targetFeedback - feedback) * inv;
+            const auto mixStep = (targetMix - mix) * inv;
+
+            auto g = coefficient;
+            auto fb = feedback;
+            auto wet = mix;
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                g += coefficientStep;
+                fb += feedbackStep;
+                wet += mixStep;
+
+                const auto x = in[i];
+                auto y = x + lastOutput * fb;
+
+                for (size_t s = 0; s < numStages; ++s)
+                {
+                    //TPT one-pole, allpass = 2 * lowpass - input
+                    const auto v = (y - states[s]) * g;
+                    const auto low = v + states[s];
+                    states[s] = low + v;
+                    y = low * 2.f - y;
+                }
+
+                lastOutput = y;
+                out[i] = x * (1.f - wet) + y * wet;
+            }
+
+            coefficient = target; //no drift from the increments
+            feedback = targetFeedback;
+            mix = targetMix;
+        }
+
+    private:
+        /** G = g / (1 + g), g = tan(pi f / fs), per lane. */
+        SampleType getCoefficientAt(float phase) const noexcept
+        {
+            SampleType result(0.f);
+
+            for (size_t lane = 0; lane < Traits::numLanes; ++lane)
+            {
+                const auto isOddChannel = ((firstLaneChannel + lane) & 1) != 0;
+                const auto lanePhase = phase + (isOddChannel ? stereoOffset : 0.f);
+                const auto lfo = std::sin(juce::MathConstants<float>::twoPi * lanePhase);
+
+                const auto norm = juce::jlimit(0.f, 1.f, normCentre + lfo * depth * 0.5f);
+                const auto frequency = minFrequency * FastMath::exp2(norm * log2Range);
+                const auto g = FastMath::tanPi(frequency / sampleRate);
+
+                Traits::set(result, lane, g / (1.f + g));
+            }
+
+            return result;
+        }
+
+        std::array<SampleType, maxStages> states;
+        SampleType lastOutput = SampleType(0.f);
+        SampleType coefficient = SampleType(0.f);
+
+        size_t numStages = 6;
+        size_t firstLaneChannel = 0;
+
+        float sampleRate = 44100.f, maxFrequency = 20000.f, log2Range = 10.f;
+        float rate = 1.f, depth = 0.5f, normCentre = 0.5f, stereoOffset = 0.f;
+        float lfoPhase = 0.f;
+        float feedback = 0.f, targetFeedback = 0.f;
+        float mix = 0.5f, targetMix = 0.5f;
+        bool snapToNextTarget = true;
+    };
+}
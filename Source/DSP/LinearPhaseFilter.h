@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    LinearPhaseFilter.h
+    Linear-phase version of the general filter: the magnitude of an
+    SVFCascadeDesign as a symmetric FIR, run by juce::dsp::Convolution.
+
+    The FIR is sampled from the design's magnitude on a grid twice as dense as
+    the taps, transformed with juce::dsp::FFT and Blackman-Harris windowed. Its
+    length only depends on the sample rate (about 85 ms), so the cost does not
+    change with the slope or Q.
+
+    The convolution is uniformly partitioned. makeFir() allocates and runs
+    FFTs, it belongs on the message thread and runs once per design however
+    many filters load the result with loadFir(). The convolution builds its
+    engine on the background thread of the ConvolutionMessageQueue it is given,
+    one for every filter of the plugin, and crossfades to the new FIR on the
+    audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SVFCascade.h"
+
+namespace ProjectAudio
+{
+    class LinearPhaseFilter
+    {
+    public:
+        static constexpr double firLengthSeconds = 0.085;
+        static constexpr int partitionSize = 256;
+
+        /** 'queue' builds the convolution engines in the background and must outlive the filter. */
+        explicit LinearPhaseFilter(juce::dsp::ConvolutionMessageQueue& queue)
+            : convolution(juce::dsp::Convolution::Latency{ partitionSize }, queue) {}
+
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            sampleRate = spec.sampleRate;
+            firSize = getFirSize(sampleRate);
+
+            convolution.prepare(spec);
+        }
+
+        void reset()
+        {
+            convolution.reset();
+        }
+
+        void process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+        {
+            convolution.process(context);
+        }
+
+        /** Centre tap of the FIR plus the partition of the convolution. */
+        int getLatencyInSamples() const { return getCentreTap() + convolution.getLatency(); }
+
+        double getLengthSeconds() const { return static_cast<double>(firSize) / sampleRate; }
+
+        double getSampleRate() const { return sampleRate; }
+
+        /** Message thread only: the FIR of 'design' at 'rate', for every filter prepared at that rate. */
+        static juce::AudioBuffer<float> makeFir(const SVFCascadeDesign& design, double rate)
+        {
+            const auto size = getFirSize(rate);
+            const auto numTaps = static_cast<size_t>(size - 1); //odd, symmetric around the centre tap
+            const auto fftSize = static_cast<size_t>(size) * 2;
+            const auto centre = static_cast<size_t>(getCentreTap(size));
+
+            //zero-phase spectrum, real bins 0 .. fftSize / 2 in JUCE's interleaved layout
+            std::vector<float> spectrum(fftSize * 2, 0.f);
+            double expectedCentreTap = 0.0; //mean of the full spectrum, independent of the FFT's scaling
+
+            for (size_t bin = 0; bin <= fftSize / 2; ++bin)
+            {
+                const auto magnitude = design.getMagnitudeAt(static_cast<double>(bin) / static_cast<double>(fftSize));
+                spectrum[bin * 2] = static_cast<float>(magnitude);
+
+                expectedCentreTap += (bin == 0 || bin == fftSize / 2) ? magnitude : 2.0 * magnitude;
+            }
+
+            expectedCentreTap /= static_cast<double>(fftSize);
+
+            juce::dsp::FFT fft(static_cast<int>(std::log2(static_cast<double>(fftSize))));
+            fft.performRealOnlyInverseTransform(spectrum.data());
+
+            const auto scale = spectrum[0] != 0.f ? static_cast<float>(expectedCentreTap) / spectrum[0] : 0.f;
+
+            std::vector<float> window(numTaps);
+            juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), numTaps,
+                                                                     juce::dsp::WindowingFunction<float>::blackmanHarris, false);
+
+            //taps -centre .. centre of the circular impulse response, delayed by centre
+            juce::AudioBuffer<float> fir(1, static_cast<int>(numTaps));
+            auto* taps = fir.getWritePointer(0);
+
+            for (size_t n = 0; n < numTaps; ++n)
+            {
+                const auto index = (n + fftSize - centre) % fftSize;
+                taps[n] = spectrum[index] * scale * window[n];
+            }
+
+            return fir;
+        }
+
+        /** Message thread only, a FIR from makeFir at this filter's rate; the convolution crossfades to it. */
+        void loadFir(const juce::AudioBuffer<float>& fir)
+        {
+            jassert(fir.getNumSamples() == firSize - 1);
+
+            juce::AudioBuffer<float> copy(fir); //the convolution keeps its own
+            convolution.loadImpulseResponse(std::move(copy), sampleRate,
+                                            juce::dsp::Convolution::Stereo::no,
+                                            juce::dsp::Convolution::Trim::no,
+                                            juce::dsp::Convolution::Normalise::no);
+        }
+
+    private:
+        static int getFirSize(double rate) { return juce::nextPowerOfTwo(juce::roundToInt(rate * firLengthSeconds)); } //4096 taps at 48 kHz
+        static int getCentreTap(int size) { return size / 2 - 1; }
+        int getCentreTap() const { return getCentreTap(firSize); }
+
+        juce::dsp::Convolution convolution;
+        double sampleRate = 44100.0;
+        int firSize = 4096;
+    };
+}
@@ -0,0 +1,252 @@
+/*
+  ==============================================================================
+
+    ModulatedSVF.h
+    Trapezoidal (TPT) state-variable filter for the general filter.
+
+    Every response is a mix of the same core, so a design is five floats
+    written in place, nothing is allocated.
+    New targets are ramped per sample across the next processed block. The
+    core stays stable for any positive g / k on the way, so sweeps and mode
+    changes never need a reset of the filter state.
+    The responses match the RBJ designs of juce::dsp::IIR::Coefficients.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ProjectAudio
+{
+    enum class SVFResponse
+    {
+        Peak,
+        Bandpass,
+        Notch,
+        Allpass,
+        LowShelf,
+        HighShelf,
+        Lowpass,
+        Highpass
+    };
+
+    //==============================================================================
+    struct SVFCoefficients
+    {
+        float g = 0.f;                          //tan(pi * f / fs)
+        float k = 2.f;                          //damping
+        float m0 = 1.f, m1 = 0.f, m2 = 0.f;     //out = m0 * in + m1 * band + m2 * low
+
+        bool operator==(const SVFCoefficients&) const = default;
+
+        /** |H| at f / fs, from the bilinear-warped analog prototype of the TPT core. */
+        double getMagnitudeAt(double normalisedFreq) const
+        {
+            const auto w = std::tan(juce::MathConstants<double>::pi * juce::jlimit(0.0, 0.4999, normalisedFreq));
+            const auto s = std::complex<double>(0.0, w / static_cast<double>(g));
+            const auto h = static_cast<double>(m0) + (static_cast<double>(m1) * s + static_cast<double>(m2))
+                                                     / (s * s + static_cast<double>(k) * s + 1.0);
+            return std::abs(h);
+        }
+
+        /** Reference design with std::tan, the audio thread uses the g overload with FastMath::tanPi. */
+        static SVFCoefficients design(SVFResponse response, double sampleRate, float freqHz, float q, float gainFactor)
+        {
+            const auto nyquistSafeHz = juce::jlimit(1.f, static_cast<float>(sampleRate * 0.499), freqHz);
+            const auto g = static_cast<float>(std::tan(juce::MathConstants<double>::pi * nyquistSafeHz / sampleRate));
+
+            return design(response, g, q, gainFactor);
+        }
+
+        /** g = tan(pi * f / fs) */
+        static SVFCoefficients design(SVFResponse response, float g, float q, float gainFactor)
+        {
+            SVFCoefficients c;
+            c.g = g;
+            c.k = 1.f / q;
+
+            switch (response)
+            {
+            case SVFResponse::Peak:
+            {
+                const auto a = std::sqrt(juce::jmax(gainFactor, 1.0e-6f)); //same A as makePeakFilter
+                c.k = 1.f / (q * a);
+                c.m1 = c.k * (a * a - 1.f);
+                break;
+            }
+
+            case SVFResponse::Bandpass: //0 dB at the centre
+                c.m0 = 0.f;
+                c.m1 = c.k;
+                break;
+
+            case SVFResponse::Notch:
+                c.m1 = -c.k;
+                break;
+
+            case SVFResponse::Allpass:
+                c.m1 = -2.f * c.k;
+                break;
+
+            case SVFResponse::LowShelf: //gainFactor below the corner, the corner moves like makeLowShelf
+            {
+                const auto a = std::sqrt(juce::jmax(gainFactor, 1.0e-6f));
+                c.g = g / std::sqrt(a);
+                c.m1 = c.k * (a - 1.f);
+                c.m2 = a * a - 1.f;
+                break;
+            }
+
+            case SVFResponse::HighShelf:
+            {
+                const auto a = std::sqrt(juce::jmax(gainFactor, 1.0e-6f));
+                c.g = g * std::sqrt(a);
+                c.m0 = a * a;
+                c.m1 = c.k * (1.f - a) * a;
+                c.m2 = 1.f - a * a;
+                break;
+            }
+
+            case SVFResponse::Lowpass:
+                c.m0 = 0.f;
+                c.m2 = 1.f;
+                break;
+
+            case SVFResponse::Highpass:
+                c.m1 = -c.k;
+                c.m2 = -1.f;
+                break;
+
+            default:
+                jassertfalse;
+                break;
+            }
+
+            return c;
+        }
+    };
+
+    //==============================================================================
+    /** One channel of SampleType (float or LaneRegister), like juce::dsp::IIR::Filter. */
+    template <typename SampleType>
+    class ModulatedSVF
+    {
+    public:
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            jassert(spec.numChannels == 1);
+            juce::ignoreUnused(spec);
+
+            snapToNextTarget = true;
+            reset();
+        }
+
+        void reset()
+        {
+            ic1eq = SampleType(0.f);
+            ic2eq = SampleType(0.f);
+        }
+
+        /** Reached by the end of the next process() call, the first target after prepare() is applied at once. */
+        void setTarget(const SVFCoefficients& newTarget)
+        {
+            target = newTarget;
+
+            if (snapToNextTarget)
+            {
+                current = target;
+                snapToNextTarget = false;
+            }
+        }
+
+        const SVFCoefficients& getTarget() const { return target; }
+
+        template <typename ProcessContext>
+        void process(const ProcessContext& context) noexcept
+        {
+            const auto& inputBlock = context.getInputBlock();
+            auto& outputBlock = context.getOutputBlock();
+
+            jassert(inputBlock.getNumChannels() == 1 && outputBlock.getNumChannels() == 1);
+
+            const auto numSamples = outputBlock.getNumSamples();
+            const auto* in = inputBlock.getChannelPointer(0);
+            auto* out = outputBlock.getChannelPointer(0);
+
+            if (context.isBypassed)
+            {
+                if (in != out)
+                    std::copy(in, in + numSamples, out);
+
+                return;
+            }
+
+            if (current == target || numSamples == 0)
+                processSteady(in, out, numSamples);
+            else
+                processRamp(in, out, numSamples);
+        }
+
+    private:
+        struct Gains { float a1, a2, a3; };
+
+        static Gains getGains(float g, float k) noexcept
+        {
+            const auto a1 = 1.f / (1.f + g * (g + k));
+            const auto a2 = g * a1;
+            return { a1, a2, g * a2 };
+        }
+
+        SampleType tick(SampleType x, const Gains& gains, float m0, float m1, float m2) noexcept
+        {
+            const auto v3 = x - ic2eq;
+            const auto v1 = ic1eq * gains.a1 + v3 * gains.a2;
+            const auto v2 = ic2eq + ic1eq * gains.a2 + v3 * gains.a3;
+
+            ic1eq = v1 * 2.f - ic1eq;
+            ic2eq = v2 * 2.f - ic2eq;
+
+            return x * m0 + v1 * m1 + v2 * m2;
+        }
+
+        void processSteady(const SampleType* in, SampleType* out, size_t numSamples) noexcept
+        {
+            const auto gains = getGains(current.g, current.k);
+
+            for (size_t i = 0; i < numSamples; ++i)
+                out[i] = tick(in[i], gains, current.m0, current.m1, current.m2);
+        }
+
+        void processRamp(const SampleType* in, SampleType* out, size_t numSamples) noexcept
+        {
+            //g and k are ramped rather than a1..a3, every step is a valid (stable) filter
+            const auto inv = 1.f / static_cast<float>(numSamples);
+            const auto dg = (target.g - current.g) * inv;
+            const auto dk = (target.k - current.k) * inv;
+            const auto dm0 = (target.m0 - current.m0) * inv;
+            const auto dm1 = (target.m1 - current.m1) * inv;
+            const auto dm2 = (target.m2 - current.m2) * inv;
+
+            auto c = current;
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                c.g += dg;
+                c.k += dk;
+                c.m0 += dm0;
+                c.m1 += dm1;
+                c.m2 += dm2;
+
+                out[i] = tick(in[i], getGains(c.g, c.k), c.m0, c.m1, c.m2);
+            }
+
+            current = target; //no drift from the float increments
+        }
+
+        SVFCoefficients current, target;
+        SampleType ic1eq = SampleType(0.f), ic2eq = SampleType(0.f);
+        bool snapToNextTarget = true;
+    };
+}
@@ -0,0 +1,195 @@
+/*
+  ==============================================================================
+
+    SIMDLaneProcessor.h
+    Keeps the channels of a block together in SIMD lanes.
+
+    Channel c lives in lane (c % lanes) of register group (c / lanes), so a
+    stereo block is one group and a mono-register filter runs once for both
+    channels instead of once per channel.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ProjectAudio
+{
+    using LaneRegister = juce::dsp::SIMDRegister<float>;
+
+    /** Lets a processor written for SampleType set one lane at a time, float has a single lane. */
+    template <typename SampleType>
+    struct LaneTraits
+    {
+        static constexpr size_t numLanes = 1;
+        static void set(SampleType& value, size_t, float laneValue) { value = laneValue; }
+        static float get(const SampleType& value, size_t) { return value; }
+
+        /** fn applied to every lane, for table lookups that have no register form. */
+        template <typename Fn>
+        static SampleType map(SampleType value, Fn&& fn) { return fn(value); }
+    };
+
+    template <>
+    struct LaneTraits<LaneRegister>
+    {
+        static constexpr size_t numLanes = LaneRegister::SIMDNumElements;
+        static void set(LaneRegister& value, size_t lane, float laneValue) { value.set(lane, laneValue); }
+        static float get(const LaneRegister& value, size_t lane) { return value.get(lane); }
+
+        template <typename Fn>
+        static LaneRegister map(LaneRegister value, Fn&& fn)
+        {
+            alignas(sizeof(LaneRegister)) float lanes[numLanes];
+            value.copyToRawArray(lanes);
+
+            for (auto& v : lanes) //a plain loop, gathers where the target has them
+                v = fn(v);
+
+            return LaneRegister::fromRawArray(lanes);
+        }
+    };
+
+    //==============================================================================
+    /** Planar <-> lane-interleaved scratch storage, allocated in prepare(). */
+    struct LaneBuffer
+    {
+        static constexpr size_t numLanes = LaneRegister::SIMDNumElements;
+
+        static size_t getNumGroupsFor(size_t numChannels) { return (numChannels + numLanes - 1) / numLanes; }
+
+        /** Only allocates when it needs more than before, so preparing again at a lower rate is free. */
+        void prepare(size_t numChannelsToUse, size_t maxSamples)
+        {
+            numChannels = numChannelsToUse;
+            const auto numGroups = getNumGroupsFor(numChannels);
+
+            storage.resize(numGroups * maxSamples);
+            groupPointers.resize(numGroups);
+
+            for (size_t g = 0; g < numGroups; ++g)
+                groupPointers[g] = storage.data() + g * maxSamples;
+
+            registers = juce::dsp::AudioBlock<LaneRegister>(groupPointers.data(), numGroups, maxSamples);
+        }
+
+        size_t getNumChannels() const { return numChannels; }
+        size_t getNumGroups() const { return registers.getNumChannels(); }
+
+        juce::dsp::AudioBlock<LaneRegister> getGroup(size_t group, size_t numSamples)
+        {
+            return registers.getSingleChannelBlock(group).getSubBlock(0, numSamples);
+        }
+
+        void interleave(const juce::dsp::AudioBlock<float>& block)
+        {
+            jassert(block.getNumChannels() == numChannels);
+            jassert(block.getNumSamples() <= registers.getNumSamples());
+
+            const auto numSamples = block.getNumSamples();
+
+            for (size_t group = 0; group < getNumGroups(); ++group)
+            {
+                auto* lanes = toFloatPointer(group);
+
+                for (size_t lane = 0; lane < numLanes; ++lane)
+                {
+                    const auto ch = group * numLanes + lane;
+
+                    if (ch < numChannels)
+                    {
+                        const auto* src = block.getChannelPointer(ch);
+
+                        for (size_t i = 0; i < numSamples; ++i)
+                            lanes[i * numLanes + lane] = src[i];
+                    }
+                    else //unused lanes carry silence
+                    {
+                        for (size_t i = 0; i < numSamples; ++i)
+                            lanes[i * numLanes + lane] = 0.f;
+                    }
+                }
+            }
+        }
+
+        void deinterleave(const juce::dsp::AudioBlock<float>& block) const
+        {
+            jassert(block.getNumChannels() == numChannels);
+
+            const auto numSamples = block.getNumSamples();
+
+            for (size_t ch = 0; ch < numChannels; ++ch)
+            {
+                const auto* lanes = toFloatPointer(ch / numLanes);
+                const auto lane = ch % numLanes;
+                auto* dst = block.getChannelPointer(ch);
+
+                for (size_t i = 0; i < numSamples; ++i)
+                    dst[i] = lanes[i * numLanes + lane];
+            }
+        }
+
+    private:
+        float* toFloatPointer(size_t group) const
+        {
+            return reinterpret_cast<float*>(registers.getChannelPointer(group));
+        }
+
+        std::vector<LaneRegister> storage;
+        std::vector<LaneRegister*> groupPointers;
+        juce::dsp::AudioBlock<LaneRegister> registers;
+        size_t numChannels = 0;
+    };
+
+    //==============================================================================
+    /**
+     Runs a processor written for one channel of LaneRegister samples over a planar
+     float block, one instance per register group.
+     Needs the channel count in prepare(), everything is allocated there. Preparing
+     again with the same channels and no larger blocks allocates nothing.
+    */
+    template <typename LaneDSP>
+    struct SIMDLaneProcessor
+    {
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            lanes.prepare(spec.numChannels, spec.maximumBlockSize);
+
+            groups.clear();
+            groups.resize(lanes.getNumGroups());
+
+            for (auto& g : groups)
+                g.prepare({ spec.sampleRate, spec.maximumBlockSize, 1 });
+        }
+
+        void process(const juce::dsp::ProcessContextReplacing<float>& context)
+        {
+            if (context.isBypassed)
+                return; //replacing context, the output already holds the input
+
+            auto& block = context.getOutputBlock();
+            lanes.interleave(block);
+
+            for (size_t g = 0; g < groups.size(); ++g)
+            {
+                auto groupBlock = lanes.getGroup(g, block.getNumSamples());
+                groups[g].process(juce::dsp::ProcessContextReplacing<LaneRegister>(groupBlock));
+            }
+
+            lanes.deinterleave(block);
+        }
+
+        void reset()
+        {
+            for (auto& g : groups)
+                g.reset();
+        }
+
+        std::vector<LaneDSP> groups;
+
+    private:
+        LaneBuffer lanes;
+    };
+}
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    SVFCascade.h
+    1 to 8 ModulatedSVF sections in series, 12 to 96 dB/oct.
+
+    Lowpass and highpass cascades are Butterworth: each section gets the pole
+    Q of the full order, the Q parameter scales the most resonant one, so
+    Q = 0.707 is maximally flat. Every other response repeats one design,
+    peak and shelf gains split evenly over the sections in dB.
+
+    Designs are computed once per update and shared by every lane and every
+    group, the sections run one after another over the whole block so each
+    keeps its state in registers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ModulatedSVF.h"
+#include "FastMath.h"
+
+namespace ProjectAudio
+{
+    namespace detail
+    {
+        inline constexpr size_t maxSVFSections = 8;
+
+        /** [numSections - 1][section], Q of the conjugate pole pairs of a Butterworth of order 2 * numSections. */
+        inline std::array<std::array<float, maxSVFSections>, maxSVFSections> makeButterworthQs()
+        {
+            std::array<std::array<float, maxSVFSections>, maxSVFSections> table{};
+
+            for (size_t n = 1; n <= maxSVFSections; ++n)
+            {
+                const auto order = 2.0 * static_cast<double>(n);
+
+                for (size_t k = 0; k < n; ++k)
+                    table[n - 1][k] = static_cast<float>(0.5 / std::sin(juce::MathConstants<double>::pi * (2.0 * k + 1.0) / (2.0 * order)));
+            }
+
+            return table;
+        }
+
+        inline const auto butterworthQs = makeButterworthQs(); //static init, never on the audio thread
+    }
+
+    //==============================================================================
+    struct SVFCascadeDesign
+    {
+        std::array<SVFCoefficients, detail::maxSVFSections> sections;
+        size_t numSections = 1;
+
+        static constexpr float flatQ = 0.70710678f;
+
+        /** Q of one section, section 0 is the most resonant. */
+        static float getSectionQ(SVFResponse response, float q, size_t numSections, size_t section)
+        {
+            if (response != SVFResponse::Lowpass && response != SVFResponse::Highpass)
+                return q;
+
+            const auto butterworthQ = detail::butterworthQs[numSections - 1][section];
+            return section == 0 ? butterworthQ * q / flatQ : butterworthQ;
+        }
+
+        double getMagnitudeAt(double normalisedFreq) const
+        {
+            auto magnitude = 1.0;
+
+            for (size_t s = 0; s < numSections; ++s)
+                magnitude *= sections[s].getMagnitudeAt(normalisedFreq);
+
+            return magnitude;
+        }
+
+        /** g = tan(pi * f / fs), the gain applies to the whole cascade. */
+        static SVFCascadeDesign design(SVFResponse response, float g, float q, float gainDb, size_t numSections)
+        {
+            SVFCascadeDesign d;
+            d.numSections = juce::jlimit<size_t>(1, detail::maxSVFSections, numSections);
+
+            const auto sectionGain = FastMath::decibelsToGain(gainDb / static_cast<float>(d.numSections));
+
+            for (size_t s = 0; s < d.numSections; ++s)
+                d.sections[s] = SVFCoefficients::design(response, g, getSectionQ(response, q, d.numSections, s), sectionGain);
+
+            return d;
+        }
+    };
+
+    //==============================================================================
+    /** One channel of SampleType (float or LaneRegister), like juce::dsp::IIR::Filter. */
+    template <typename SampleType>
+    class SVFCascade
+    {
+    public:
+        static constexpr size_t maxSections = detail::maxSVFSections;
+
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            for (auto& s : sections)
+                s.prepare(spec);
+        }
+
+        void reset()
+        {
+            for (auto& s : sections)
+                s.reset();
+        }
+
+        /** Sections that join start from silence and ramp to their design across the next block. */
+        void setTarget(const SVFCascadeDesign& design)
+        {
+            for (auto s = numSections; s < design.numSections; ++s)
+                sections[s].reset();
+
+            numSections = design.numSections;
+
+            for (size_t s = 0; s < numSections; ++s)
+                sections[s].setTarget(design.sections[s]);
+        }
+
+        size_t getNumSections() const { return numSections; }
+
+        template <typename ProcessContext>
+        void process(const ProcessContext& context) noexcept
+        {
+            sections[0].process(context);
+
+            if (context.isBypassed)
+                return; //the first section already copied the input
+
+            //the rest run in place on the output
+            auto& outputBlock = context.getOutputBlock();
+
+            for (size_t s = 1; s < numSections; ++s)
+                sections[s].process(juce::dsp::ProcessContextReplacing<SampleType>(outputBlock));
+        }
+
+    private:
+        std::array<ModulatedSVF<SampleType>, maxSections> sections;
+        size_t numSections = 1;
+    };
+}
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    SmootherBank.h
+    A fixed number of parameter smoothers stored as structure-of-arrays.
+
+    Behaves like juce::SmoothedValue (linear or multiplicative ramps of a fixed
+    length), but every smoother advances in the same vectorised pass and nothing
+    is allocated after construction.
+    Each smoother has a version that moves whenever its value does, so callers
+    can tell whether anything changed without comparing values.
+    Multiplicative ramps are linear ramps of log(value), so both modes share
+    the same kernel and only the read-out differs.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <bitset>
+
+namespace ProjectAudio
+{
+    enum class SmoothingMode
+    {
+        Linear,
+        Multiplicative //for frequencies/times, values must stay > 0
+    };
+
+    template <size_t NumSmoothers>
+    class SmootherBank
+    {
+    public:
+        static constexpr size_t size() { return NumSmoothers; }
+
+        SmootherBank()
+        {
+            for (auto* a : { &ramp, &target, &step, &remaining, &advance, &values })
+                a->fill(0.f);
+
+            multiplicative.fill(false);
+            versions.fill(0);
+        }
+
+        void setMode(size_t index, SmoothingMode mode)
+        {
+            multiplicative[index] = (mode == SmoothingMode::Multiplicative);
+        }
+
+        /** Ramp length for all smoothers, stops any ramp in progress. */
+        void reset(double sampleRate, double rampLengthInSeconds)
+        {
+            rampLength = static_cast<float>(juce::jmax(1.0, std::floor(rampLengthInSeconds * sampleRate)));
+
+            ramp = target;
+            remaining.fill(0.f);
+
+            for (size_t i = 0; i < NumSmoothers; ++i)
+            {
+                values[i] = fromRampDomain(i, ramp[i]);
+                ++versions[i];
+            }
+        }
+
+        void setCurrentAndTargetValue(size_t index, float newValue)
+        {
+            target[index] = ramp[index] = toRampDomain(index, newValue);
+            remaining[index] = 0.f;
+            step[index] = 0.f;
+            values[index] = newValue;
+            ++versions[index];
+        }
+
+        void setTargetValue(size_t index, float newValue)
+        {
+            const auto newTarget = toRampDomain(index, newValue);
+
+            if (newTarget == target[index])
+                return;
+
+            target[index] = newTarget;
+            remaining[index] = rampLength;
+            step[index] = (newTarget - ramp[index]) / rampLength;
+        }
+
+        /** One target per smoother, read once per block by the caller. */
+        void setTargetValues(const std::array<float, NumSmoothers>& newValues)
+        {
+            for (size_t i = 0; i < NumSmoothers; ++i)
+                setTargetValue(i, newValues[i]);
+        }
+
+        /** Advances every smoother by numSamples in one pass. */
+        void skip(int numSamples)
+        {
+            using FVO = juce::FloatVectorOperations;
+            constexpr auto n = static_cast<int>(NumSmoothers);
+
+            FVO::min(advance.data(), remaining.data(), static_cast<float>(numSamples), n); //samples left of each ramp
+            FVO::addWithMultiply(ramp.data(), step.data(), advance.data(), n);
+            FVO::subtract(remaining.data(), advance.data(), n);
+
+            for (size_t i = 0; i < NumSmoothers; ++i) //finished ramps land exactly on target
+            {
+                ramp[i] = remaining[i] > 0.f ? ramp[i] : target[i];
+                versions[i] += advance[i] > 0.f ? 1u : 0u;
+            }
+
+            updateValues();
+        }
+
+        float getCurrentValue(size_t index) const { return values[index]; }
+        float getTargetValue(size_t index) const { return fromRampDomain(index, target[index]); }
+        bool isSmoothing(size_t index) const { return remaining[index] > 0.f; }
+
+        juce::uint32 getVersion(size_t index) const { return versions[index]; }
+
+        /** Sum of the versions in 'mask', moves when any of those smoothers moved. */
+        juce::uint64 getVersion(const std::bitset<NumSmoothers>& mask) const
+        {
+            juce::uint64 sum = 0;
+
+            for (size_t i = 0; i < NumSmoothers; ++i)
+                sum += mask[i] ? versions[i] : 0u;
+
+            return sum;
+        }
+
+    private:
+        float toRampDomain(size_t index, float v) const
+        {
+            jassert(!multiplicative[index] || v > 0.f);
+            return multiplicative[index] ? std::log(v) : v;
+        }
+
+        float fromRampDomain(size_t index, float r) const
+        {
+            return multiplicative[index] ? std::exp(r) : r;
+        }
+
+        void updateValues()
+        {
+            for (size_t i = 0; i < NumSmoothers; ++i)
+            {
+                if (!multiplicative[i])
+                    values[i] = ramp[i];
+                else if (advance[i] > 0.f) //only lanes that moved pay for the exp
+                    values[i] = std::exp(ramp[i]);
+            }
+        }
+
+        alignas(16) std::array<float, NumSmoothers> ramp, target, step, remaining, advance, values;
+        std::array<bool, NumSmoothers> multiplicative;
+        std::array<juce::uint32, NumSmoothers> versions;
+        float rampLength = 1.f;
+    };
+}
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    StageOversampler.h
+    Runs one stage of the chain at 1x/2x/4x/8x the host rate.
+
+    Every factor and filter type is built in prepare(), so switching at run
+    time only selects another engine. The half-band filters are the polyphase
+    ones of juce::dsp::Oversampling:
+      IIR  polyphase allpass half-bands, low latency, not linear phase
+      FIR  equiripple half-bands, linear phase, more latency
+    Latency is rounded to whole samples by juce::dsp::Oversampling itself, so
+    it can be reported to the host as is.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ProjectAudio
+{
+    class StageOversampler
+    {
+    public:
+        enum class FilterType
+        {
+            IIR, //low latency
+            FIR  //linear phase
+        };
+
+        static constexpr size_t maxFactorLog2 = 3; //8x
+
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            baseSpec = spec;
+
+            for (size_t factorLog2 = 1; factorLog2 <= maxFactorLog2; ++factorLog2)
+            {
+                for (auto type : { FilterType::IIR, FilterType::FIR })
+                {
+                    auto& engine = engines[getIndex(factorLog2, type)];
+                    engine = std::make_unique<juce::dsp::Oversampling<float>>(spec.numChannels, factorLog2,
+                                                                              type == FilterType::IIR
+                                                                                  ? juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR
+                                                                                  : juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple,
+                                                                              true, true);
+                    engine->initProcessing(spec.maximumBlockSize);
+                }
+            }
+
+            current = nullptr;
+            currentFactorLog2 = invalidFactor; //the first setConfig() always reports a change
+        }
+
+        /** Returns true when the rate seen by the stage changed, the stage must be prepared with getProcessSpec() then. */
+        bool setConfig(size_t factorLog2, FilterType type)
+        {
+            factorLog2 = juce::jmin(factorLog2, maxFactorLog2);
+            auto* engine = factorLog2 == 0 ? nullptr : engines[getIndex(factorLog2, type)].get();
+
+            if (engine == current && factorLog2 == currentFactorLog2)
+                return false;
+
+            const auto rateChanged = factorLog2 != currentFactorLog2;
+
+            current = engine;
+            currentFactorLog2 = factorLog2;
+
+            if (current != nullptr)
+                current->reset();
+
+            return rateChanged;
+        }
+
+        /** The spec the stage runs at with the current factor. */
+        juce::dsp::ProcessSpec getProcessSpec() const
+        {
+            const auto factor = static_cast<juce::uint32>(1u << juce::jmin(currentFactorLog2, maxFactorLog2));
+            return { baseSpec.sampleRate * factor, baseSpec.maximumBlockSize * factor, baseSpec.numChannels };
+        }
+
+        /** The spec at 8x, preparing a stage with it first reserves its buffers for every factor. */
+        juce::dsp::ProcessSpec getMaxProcessSpec() const
+        {
+            constexpr auto factor = static_cast<juce::uint32>(1u << maxFactorLog2);
+            return { baseSpec.sampleRate * factor, baseSpec.maximumBlockSize * factor, baseSpec.numChannels };
+        }
+
+        /** Latency at the host rate for any configuration, safe to call from any thread after prepare(). */
+        int getLatencyInSamples(size_t factorLog2, FilterType type) const
+        {
+            factorLog2 = juce::jmin(factorLog2, maxFactorLog2);
+
+            if (factorLog2 == 0)
+                return 0;
+
+            auto& engine = engines[getIndex(factorLog2, type)];
+            return engine != nullptr ? juce::roundToInt(engine->getLatencyInSamples()) : 0;
+        }
+
+        /** processAtRate(block) gets the up-sampled block, or the block itself at 1x. */
+        template <typename ProcessAtRate>
+        void process(juce::dsp::AudioBlock<float> block, ProcessAtRate&& processAtRate)
+        {
+            if (current == nullptr)
+            {
+                processAtRate(block);
+                return;
+            }
+
+            processAtRate(current->processSamplesUp(block));
+            current->processSamplesDown(block);
+        }
+
+        void reset()
+        {
+            if (current != nullptr)
+                current->reset();
+        }
+
+    private:
+        static constexpr size_t invalidFactor = 255;
+
+        static size_t getIndex(size_t factorLog2, FilterType type)
+        {
+            return (factorLog2 - 1) * 2 + (type == FilterType::IIR ? 0 : 1);
+        }
+
+        std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, maxFactorLog2 * 2> engines;
+        juce::dsp::Oversampling<float>* current = nullptr;
+        size_t currentFactorLog2 = invalidFactor;
+        juce::dsp::ProcessSpec baseSpec{};
+    };
+}
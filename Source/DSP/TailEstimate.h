@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    TailEstimate.h
+    Time until a stage's output has decayed 60 dB after its input stopped.
+
+    Closed-form upper bounds from the parameters, cheap enough to evaluate
+    once per block. A chain of stages rings for at most the sum of its tails.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace ProjectAudio::TailEstimate
+{
+    inline constexpr double ln1000 = 6.907755278982137; //-60 dB
+
+    /** Trips around a feedback loop until the signal is 60 dB down, at least one. */
+    inline double feedbackTrips(double feedback)
+    {
+        const auto fb = juce::jmin(std::abs(feedback), 0.999);
+        return fb > 1.0e-3 ? juce::jmax(1.0, ln1000 / -std::log(fb)) : 1.0;
+    }
+
+    /** First-order pole, envelope exp(-2 pi f t). */
+    inline double onePole(double freqHz)
+    {
+        return ln1000 / (juce::MathConstants<double>::twoPi * juce::jmax(1.0, freqHz));
+    }
+
+    /** Second-order resonance, envelope exp(-pi * f * t / Q). */
+    inline double resonance(double freqHz, double q)
+    {
+        return ln1000 * q / (juce::MathConstants<double>::pi * juce::jmax(1.0, freqHz));
+    }
+
+    /** LanePhaser: a chain of first-order allpasses with feedback around it.
+        The allpass frequencies stay above 20 Hz. */
+    inline double phaser(double centreHz, double feedback, int numStages = 6)
+    {
+        const auto omega = juce::MathConstants<double>::twoPi * juce::jmax(20.0, centreHz);
+        const auto chainDelay = numStages * 2.0 / omega; //group delay of the chain at DC
+
+        return ln1000 / omega + chainDelay * feedbackTrips(feedback);
+    }
+
+    /** EnsembleChorus: the longest modulated delay, repeated by the feedback. */
+    inline double chorus(double centreDelayMs, double depth, double feedback)
+    {
+        const auto maxDelaySeconds = (centreDelayMs + 10.0 * depth) * 0.001; //modulated by up to 10 ms * depth
+
+        return maxDelaySeconds * feedbackTrips(feedback);
+    }
+
+    /** juce::dsp::LadderFilter, resonance 0..1, 1 self-oscillates (capped at Q = 50). */
+    inline double ladder(double cutoffHz, double resonance01)
+    {
+        const auto q = 0.5 / (1.0 - 0.99 * juce::jlimit(0.0, 1.0, resonance01));
+        return resonance(cutoffHz, q);
+    }
+
+    /** One ModulatedSVF section, the peak response narrows the poles by sqrt(gain) on a boost. */
+    inline double svf(double freqHz, double q, double peakGainFactor = 1.0)
+    {
+        return resonance(freqHz, q * std::sqrt(juce::jmax(1.0, peakGainFactor)));
+    }
+}
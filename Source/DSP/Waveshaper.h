@@ -0,0 +1,260 @@
+/*
+  ==============================================================================
+
+    Waveshaper.h
+    Memoryless overdrive with first-order antiderivative anti-aliasing (ADAA).
+
+    out = f(drive * in), f one of the curves below, all with slope 1 at 0:
+      Tanh            symmetric, odd harmonics
+      SoftClip        cubic, flat above |u| = 1.5
+      AsymmetricTube  soft clip, the negative half clips at half the level,
+                      adds even harmonics and DC (removed by a 5 Hz blocker)
+
+    ADAA replaces f(u[n]) by (F(u[n]) - F(u[n-1])) / (u[n] - u[n-1]), F the
+    antiderivative. Aliasing drops by about the same amount as 2x oversampling
+    for half a sample of delay. Each F is split into a piecewise linear part and
+    a bounded rest, so the difference quotient does not cancel in float at high
+    drive.
+
+    Every pass is a branch-free loop over one channel; ADAA depends on inputs
+    only, so nothing is carried from sample to sample and compilers vectorise
+    the loops. No table lookups, the curves are polynomials plus FastMath::exp2.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FastMath.h"
+
+namespace ProjectAudio
+{
+    enum class ShaperCurve
+    {
+        Tanh,
+        SoftClip,
+        AsymmetricTube
+    };
+
+    namespace ShaperCurves
+    {
+        /** F(u) = linear(u) + bounded(u), d/du F = shape. */
+        struct Tanh
+        {
+            static float shape(float u) noexcept
+            {
+                const auto e = FastMath::exp2(-2.88539008178f * std::abs(u)); //exp(-2|u|)
+                return std::copysign((1.f - e) / (1.f + e), u);
+            }
+
+            static float linear(float u) noexcept { return std::abs(u); }
+
+            /** log(cosh(u)) - |u| = log1p(exp(-2|u|)) - log(2) */
+            static float bounded(float u) noexcept
+            {
+                const auto e = FastMath::exp2(-2.88539008178f * std::abs(u));
+
+                //log1p(e) = 2 atanh(s), s = e / (2 + e) in [0, 1/3], error < 1e-7
+                const auto s = e / (2.f + e);
+                const auto s2 = s * s;
+                const auto log1pE = 2.f * s * (1.f + s2 * (1.f / 3.f + s2 * (1.f / 5.f + s2 * (1.f / 7.f + s2 * (1.f / 9.f + s2 * (1.f / 11.f))))));
+
+                return log1pE - 0.69314718056f;
+            }
+        };
+
+        /** 1.5 (c - c^3 / 3), c = clamp(u / 1.5) */
+        struct SoftClip
+        {
+            static float shape(float u) noexcept
+            {
+                const auto c = juce::jlimit(-1.f, 1.f, u * (1.f / 1.5f));
+                return 1.5f * c * (1.f - c * c * (1.f / 3.f));
+            }
+
+            static float linear(float u) noexcept { return std::abs(u); }
+
+            static float bounded(float u) noexcept
+            {
+                const auto c = juce::jlimit(-1.f, 1.f, u * (1.f / 1.5f));
+                const auto c2 = c * c;
+                return 2.25f * c2 * (0.5f - c2 * (1.f / 12.f)) - 1.5f * std::abs(c);
+            }
+        };
+
+        /** SoftClip above 0, SoftClip(2u) / 2 below */
+        struct AsymmetricTube
+        {
+            static float shape(float u) noexcept
+            {
+                return u >= 0.f ? SoftClip::shape(u) : 0.5f * SoftClip::shape(2.f * u);
+            }
+
+            static float linear(float u) noexcept { return u >= 0.f ? u : -0.5f * u; }
+
+            static float bounded(float u) noexcept
+            {
+                return u >= 0.f ? SoftClip::bounded(u) : 0.25f * SoftClip::bounded(2.f * u);
+            }
+        };
+    }
+
+    //==============================================================================
+    class Waveshaper
+    {
+    public:
+        static constexpr double dcBlockerHz = 5.0;
+
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            drive.resize(spec.maximumBlockSize);
+            shaped.resize(spec.maximumBlockSize + 1); //[0] holds the last sample of the previous block
+            bounded.resize(spec.maximumBlockSize + 1);
+            channels.resize(spec.numChannels);
+
+            dcCoefficient = static_cast<float>(std::exp(-juce::MathConstants<double>::twoPi * dcBlockerHz / spec.sampleRate));
+
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto& c : channels)
+                c = {};
+
+            currentDrive = targetDrive;
+        }
+
+        void setCurve(ShaperCurve newCurve)
+        {
+            if (newCurve == ShaperCurve::AsymmetricTube && curve != newCurve)
+            {
+                for (auto& c : channels) //the blocker starts from nothing, not from an old DC estimate
+                    c.dcIn = c.dcOut = 0.f;
+            }
+
+            curve = newCurve;
+        }
+
+        ShaperCurve getCurve() const { return curve; }
+
+        void setAntiAliasing(bool shouldUseADAA) { useADAA = shouldUseADAA; }
+
+        /** Linear gain before the curve, ramped across the next block. */
+        void setDrive(float newDrive) { targetDrive = newDrive; }
+
+        void process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+        {
+            if (context.isBypassed)
+                return; //replacing context, the output already holds the input
+
+            auto& block = context.getOutputBlock();
+            const auto numSamples = block.getNumSamples();
+            jassert(numSamples <= drive.size() && block.getNumChannels() <= channels.size());
+
+            if (numSamples == 0)
+                return;
+
+            //one drive ramp for every channel
+            const auto step = (targetDrive - currentDrive) / static_cast<float>(numSamples);
+
+            for (size_t i = 0; i < numSamples; ++i)
+                drive[i] = currentDrive + step * static_cast<float>(i + 1);
+
+            currentDrive = targetDrive;
+
+            for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+            {
+                auto* samples = block.getChannelPointer(ch);
+
+                switch (curve)
+                {
+                case ShaperCurve::Tanh:           processChannel<ShaperCurves::Tanh>(samples, numSamples, channels[ch]); break;
+                case ShaperCurve::SoftClip:       processChannel<ShaperCurves::SoftClip>(samples, numSamples, channels[ch]); break;
+                case ShaperCurve::AsymmetricTube: processChannel<ShaperCurves::AsymmetricTube>(samples, numSamples, channels[ch]); break;
+                default: jassertfalse; break;
+                }
+
+                if (curve == ShaperCurve::AsymmetricTube)
+                    removeDC(samples, numSamples, channels[ch]);
+            }
+        }
+
+    private:
+        struct ChannelState
+        {
+            float lastInput = 0.f; //drive * in, last sample of the previous block
+            float dcIn = 0.f, dcOut = 0.f;
+        };
+
+        template <typename Curve>
+        void processChannel(float* samples, size_t numSamples, ChannelState& state) noexcept
+        {
+            const auto lastInput = samples[numSamples - 1] * drive[numSamples - 1];
+
+            if (!useADAA)
+            {
+                for (size_t i = 0; i < numSamples; ++i)
+                    samples[i] = Curve::shape(samples[i] * drive[i]);
+
+                state.lastInput = lastInput; //ADAA can be switched on without a jump
+                return;
+            }
+
+            //u[n] with u[-1] in front, then the bounded part of F for every u
+            //u[-1] goes through the current curve too, so curve changes do not glitch
+            auto* u = shaped.data();
+            auto* b = bounded.data();
+
+            u[0] = state.lastInput;
+
+            for (size_t i = 0; i < numSamples; ++i)
+                u[i + 1] = samples[i] * drive[i];
+
+            for (size_t i = 0; i <= numSamples; ++i)
+                b[i] = Curve::bounded(u[i]);
+
+            //both branches are computed and selected, keeps the loop vectorisable
+            constexpr float minDelta = 1.0e-3f; //below this the midpoint is closer than the quotient
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                const auto u0 = u[i], u1 = u[i + 1];
+                const auto delta = u1 - u0;
+                const auto safeDelta = std::abs(delta) < minDelta ? 1.f : delta;
+
+                const auto quotient = (Curve::linear(u1) - Curve::linear(u0) + b[i + 1] - b[i]) / safeDelta;
+                const auto midpoint = Curve::shape(0.5f * (u0 + u1));
+
+                samples[i] = std::abs(delta) < minDelta ? midpoint : quotient;
+            }
+
+            state.lastInput = lastInput;
+        }
+
+        /** y = x - x[-1] + R y[-1] */
+        void removeDC(float* samples, size_t numSamples, ChannelState& state) const noexcept
+        {
+            auto x1 = state.dcIn, y1 = state.dcOut;
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                const auto x = samples[i];
+                y1 = x - x1 + dcCoefficient * y1;
+                x1 = x;
+                samples[i] = y1;
+            }
+
+            state.dcIn = x1;
+            state.dcOut = y1;
+        }
+
+        std::vector<float> drive, shaped, bounded;
+        std::vector<ChannelState> channels;
+
+        ShaperCurve curve = ShaperCurve::Tanh;
+        bool useADAA = true;
+        float currentDrive = 1.f, targetDrive = 1.f;
+        float dcCoefficient = 0.f;
+    };
+}
@@ -0,0 +1,392 @@
+/*
+  ==============================================================================
+
+    WorkerPool.h
+    A few realtime worker threads that help the audio thread with independent
+    tasks: the branches of a split, the stages of a pipeline, the bands.
+
+    One pool serves every plugin instance in the process (WorkerClient holds it
+    through a juce::SharedResourcePointer), and runs only as many threads as
+    the widest client asks for, capped by the spare cores. A client whose
+    routing has nothing to run in parallel asks for none.
+
+    run() pushes the tasks onto the client's own work-stealing deque (Chase-Lev,
+    fixed capacity, lock-free), works through them from the bottom itself while
+    the workers steal from the top, and returns once every task has finished.
+    The caller never waits for a worker to wake up: a task nobody stole is run
+    by the caller, so a sleeping pool only costs speed.
+
+    Workers spin for a moment after their last task, long enough to catch the
+    next split of the same host block, then sleep on a wake counter of their
+    own (C++20 atomic wait, a futex or its equivalent) until run() bumps it.
+    The wake takes no lock: it is the only system call the audio thread makes
+    here, and only for workers that are asleep.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <thread>
+#include "../Debug/RealtimeSafety.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+namespace ProjectAudio
+{
+    inline void spinPause() noexcept
+    {
+       #if JUCE_INTEL
+        _mm_pause();
+       #else
+        std::this_thread::yield();
+       #endif
+    }
+
+    /** Chase-Lev deque of task indices: one owner pushes and pops at the bottom, any thread steals from the top. */
+    template <size_t Capacity>
+    class WorkStealingDeque
+    {
+    public:
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+        static constexpr int empty = -1;
+
+        /** Owner only, never more than Capacity tasks at once. */
+        void push(int task) noexcept
+        {
+            const auto b = bottom.load(std::memory_order_relaxed);
+            jassert(b - top.load(std::memory_order_acquire) < static_cast<juce::int64>(Capacity));
+
+            tasks[static_cast<size_t>(b) & mask].store(task, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_release); //the task, and whatever the owner wrote before it, to the thieves
+        }
+
+        /** Owner only, newest task first. */
+        int pop() noexcept
+        {
+            const auto b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto t = top.load(std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                bottom.store(b + 1, std::memory_order_relaxed); //was empty
+                return empty;
+            }
+
+            auto task = tasks[static_cast<size_t>(b) & mask].load(std::memory_order_relaxed);
+
+            if (t == b) //last task, race the thieves for it
+            {
+                if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    task = empty;
+
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+
+            return task;
+        }
+
+        /** Any thread, oldest task first; empty when there was none or another thread won it. */
+        int steal() noexcept
+        {
+            auto t = top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const auto b = bottom.load(std::memory_order_acquire);
+
+            if (t >= b)
+                return empty;
+
+            const auto task = tasks[static_cast<size_t>(t) & mask].load(std::memory_order_relaxed);
+
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return empty;
+
+            return task;
+        }
+
+    private:
+        static constexpr size_t mask = Capacity - 1;
+
+        alignas(64) std::atomic<juce::int64> top{ 0 };
+        alignas(64) std::atomic<juce::int64> bottom{ 0 };
+        std::array<std::atomic<int>, Capacity> tasks{};
+    };
+
+    class WorkerPool
+    {
+    public:
+        static constexpr int maxWorkers = 7;
+        static constexpr int maxClients = 16; //plugin instances with a lane of their own, the rest run serially
+        static constexpr size_t maxTasks = 64;
+        static constexpr double spinMilliseconds = 0.5; //the gaps inside a host block, not the gaps between them
+
+        WorkerPool()
+        {
+            //the objects live as long as the pool, so run() may wake any of them, the threads come and go in resize
+            for (int i = 0; i < maxWorkers; ++i)
+                workers[static_cast<size_t>(i)] = std::make_unique<Worker>(*this, i);
+        }
+
+        ~WorkerPool() { resize(0); }
+
+        /** Message thread: a lane for one client, -1 when every lane is taken. */
+        int acquireLane()
+        {
+            const juce::ScopedLock sl(lock);
+
+            for (int i = 0; i < maxClients; ++i)
+            {
+                if (!lanes[static_cast<size_t>(i)].inUse)
+                {
+                    lanes[static_cast<size_t>(i)].inUse = true;
+                    return i;
+                }
+            }
+
+            return -1;
+        }
+
+        /** Message thread: the lane's client is gone, the pool shrinks to what the others ask for. */
+        void releaseLane(int lane)
+        {
+            if (lane < 0)
+                return;
+
+            const juce::ScopedLock sl(lock);
+            lanes[static_cast<size_t>(lane)].inUse = false;
+            lanes[static_cast<size_t>(lane)].demand = 0;
+            resize(getWantedWorkers());
+        }
+
+        /** Message thread: the workers this lane's client could keep busy, the pool follows the largest demand. */
+        void setDemand(int lane, int numWorkers, int samplesPerBlock, double sampleRate)
+        {
+            if (lane < 0)
+                return;
+
+            const juce::ScopedLock sl(lock);
+            lanes[static_cast<size_t>(lane)].demand = juce::jmax(0, numWorkers);
+            realtimeOptions = juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime(samplesPerBlock, sampleRate);
+            resize(getWantedWorkers());
+        }
+
+        int getNumWorkers() const noexcept { return numRunning.load(std::memory_order_acquire); }
+
+        /** Audio thread of the lane's client: task(index) for every index below numTasks. Returns when all are done. */
+        template <typename Task>
+        void run(int laneIndex, size_t numTasks, Task& task)
+        {
+            jassert(numTasks <= maxTasks);
+            auto& lane = lanes[static_cast<size_t>(laneIndex)];
+
+            //published by the release store in push before any thief can see a task
+            lane.context = &task;
+            lane.invoke = [](void* c, int index) { (*static_cast<Task*>(c))(index); };
+            lane.pending.store(static_cast<int>(numTasks), std::memory_order_relaxed);
+
+            for (auto i = static_cast<int>(numTasks); --i >= 0;)
+                lane.deque.push(i); //the caller pops task 0 first, thieves start at the other end
+
+            //a worker counts itself asleep before it looks for work one last time, so one of the two sees the other
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto toWake = static_cast<int>(numTasks) - 1;
+
+            for (size_t i = 0; i < workers.size() && toWake > 0; ++i)
+            {
+                if (workers[i]->sleeping.load(std::memory_order_relaxed))
+                {
+                    workers[i]->wake();
+                    --toWake;
+                }
+            }
+
+            for (auto index = lane.deque.pop(); index != WorkStealingDeque<maxTasks>::empty; index = lane.deque.pop())
+            {
+                lane.invoke(lane.context, index);
+                lane.pending.fetch_sub(1, std::memory_order_release);
+            }
+
+            //only tasks a worker already started are left, bounded by one task's cost
+            while (lane.pending.load(std::memory_order_acquire) > 0)
+                spinPause();
+        }
+
+    private:
+        struct Lane
+        {
+            WorkStealingDeque<maxTasks> deque; //owned by the client's audio thread
+            void* context = nullptr;
+            void (*invoke)(void*, int) = nullptr;
+            alignas(64) std::atomic<int> pending{ 0 };
+
+            bool inUse = false; //message thread, under the lock
+            int demand = 0;
+        };
+
+        struct Worker : juce::Thread
+        {
+            Worker(WorkerPool& ownerPool, int index) : juce::Thread("ProjectAudio worker " + juce::String(index + 1)), pool(ownerPool), firstLane(index) {}
+
+            void run() override
+            {
+                auto lastTask = juce::Time::getMillisecondCounterHiRes();
+
+                while (!threadShouldExit())
+                {
+                    if (pool.runStolenTask(firstLane))
+                    {
+                        lastTask = juce::Time::getMillisecondCounterHiRes();
+                        continue;
+                    }
+
+                    if (juce::Time::getMillisecondCounterHiRes() - lastTask < spinMilliseconds)
+                    {
+                        spinPause();
+                        continue;
+                    }
+
+                    //a wake that comes before the wait changed the counter and is kept, one that finds work already done only wakes us for nothing
+                    const auto seen = wakeups.load(std::memory_order_acquire);
+                    sleeping.store(true, std::memory_order_seq_cst);
+
+                    if (!pool.runStolenTask(firstLane) && !threadShouldExit())
+                        wakeups.wait(seen, std::memory_order_acquire);
+
+                    sleeping.store(false, std::memory_order_relaxed);
+                    lastTask = juce::Time::getMillisecondCounterHiRes();
+                }
+            }
+
+            /** Any thread, no lock: a futex wake (or the platform's address wait) where juce::Thread::notify would take a mutex. */
+            void wake() noexcept
+            {
+                wakeups.fetch_add(1, std::memory_order_release);
+                wakeups.notify_one();
+            }
+
+            WorkerPool& pool;
+            int firstLane; //workers start their search on different lanes
+            std::atomic<bool> sleeping{ false };
+            std::atomic<juce::uint32> wakeups{ 0 };
+        };
+
+        int getWantedWorkers() const
+        {
+            int demand = 0;
+
+            for (const auto& lane : lanes)
+                demand = juce::jmax(demand, lane.demand);
+
+            //the audio threads are the other cores
+            return juce::jlimit(0, juce::jmin(maxWorkers, juce::SystemStats::getNumCpus() - 1), demand);
+        }
+
+        /** Under the lock: a client's run() copes with any number of workers, so none has to stop playing for this. */
+        void resize(int numWorkers)
+        {
+            const auto running = numRunning.load(std::memory_order_relaxed);
+
+            if (numWorkers == running)
+                return;
+
+            numRunning.store(juce::jmin(numWorkers, running), std::memory_order_release);
+
+            for (auto i = static_cast<size_t>(numWorkers); i < static_cast<size_t>(running); ++i)
+            {
+                workers[i]->signalThreadShouldExit();
+                workers[i]->wake(); //a sleeping worker checks threadShouldExit once it wakes
+            }
+
+            for (auto i = static_cast<size_t>(numWorkers); i < static_cast<size_t>(running); ++i)
+                workers[i]->stopThread(1000);
+
+            for (auto i = static_cast<size_t>(running); i < static_cast<size_t>(numWorkers); ++i)
+            {
+                //realtime where the OS allows it, workgroup-joined on macOS by the period it is given
+                if (!workers[i]->startRealtimeThread(realtimeOptions))
+                    workers[i]->startThread(juce::Thread::Priority::highest);
+            }
+
+            numRunning.store(numWorkers, std::memory_order_release);
+        }
+
+        bool runStolenTask(int firstLane)
+        {
+            for (int i = 0; i < maxClients; ++i)
+            {
+                auto& lane = lanes[static_cast<size_t>((firstLane + i) % maxClients)];
+                const auto index = lane.deque.steal();
+
+                if (index == WorkStealingDeque<maxTasks>::empty)
+                    continue;
+
+                ProjectAudio::RealtimeSafety::ScopedRealtimeThread realtimeScope; //the task runs under the audio thread's rules
+                lane.invoke(lane.context, index);
+                lane.pending.fetch_sub(1, std::memory_order_release);
+                return true;
+            }
+
+            return false;
+        }
+
+        std::array<Lane, maxClients> lanes;
+
+        std::array<std::unique_ptr<Worker>, maxWorkers> workers; //the first numRunning have a thread
+
+        juce::CriticalSection lock;
+        juce::Thread::RealtimeOptions realtimeOptions;
+        std::atomic<int> numRunning{ 0 };
+
+        JUCE_DECLARE_NON_COPYABLE(WorkerPool)
+    };
+
+    /** One plugin instance's share of the process-wide WorkerPool. */
+    class WorkerClient
+    {
+    public:
+        WorkerClient() : lane(pool->acquireLane()) {}
+        ~WorkerClient() { pool->releaseLane(lane); }
+
+        /** Message thread: the workers this instance could keep busy besides its audio thread, 0 when nothing runs in parallel. */
+        void setDemand(int numWorkers, int samplesPerBlock, double sampleRate)
+        {
+            demand.store(juce::jmax(0, numWorkers), std::memory_order_release);
+            pool->setDemand(lane, numWorkers, samplesPerBlock, sampleRate);
+        }
+
+        /** Workers that may help this instance, 0 runs everything on the calling thread. */
+        int getNumWorkers() const noexcept
+        {
+            return lane < 0 ? 0 : juce::jmin(demand.load(std::memory_order_acquire), pool->getNumWorkers());
+        }
+
+        /** Audio thread: task(index) for every index below numTasks, on this thread and the workers. Returns when all are done. */
+        template <typename Task>
+        void run(size_t numTasks, Task& task)
+        {
+            if (numTasks <= 1 || getNumWorkers() == 0)
+            {
+                for (size_t i = 0; i < numTasks; ++i)
+                    task(static_cast<int>(i));
+
+                return;
+            }
+
+            pool->run(lane, numTasks, task);
+        }
+
+    private:
+        juce::SharedResourcePointer<WorkerPool> pool; //first in, last out: the lane goes back before the pool can
+        const int lane;
+        std::atomic<int> demand{ 0 };
+
+        JUCE_DECLARE_NON_COPYABLE(WorkerClient)
+    };
+}
@@ -0,0 +1,185 @@
+/*
+  ==============================================================================
+
+    ZDFLadder.h
+    Zero-delay-feedback (TPT) Moog ladder, a drop-in for juce::dsp::LadderFilter.
+
+    Four TPT one-poles with the resonance feedback solved per sample, so the
+    cutoff and resonance are exact up to Nyquist instead of only at low
+    frequencies. Modes, drive and resonance ranges follow juce::dsp::LadderFilter:
+    the input goes through gain * tanh(drive * in), the loop input is saturated
+    once more, which bounds self-oscillation at full resonance.
+
+    Setters run FastMath once per control-rate update; the cutoff, resonance and
+    drive are ramped per sample across the next block, which costs a division
+    and no transcendental per sample. tanh is FastMath's table.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "SIMDLaneProcessor.h"
+#include "FastMath.h"
+
+namespace ProjectAudio
+{
+    /** One channel of SampleType (float or LaneRegister), run by SIMDLaneProcessor. */
+    template <typename SampleType>
+    class ZDFLadder
+    {
+    public:
+        using Traits = LaneTraits<SampleType>;
+        using Mode = juce::dsp::LadderFilterMode;
+
+        void prepare(const juce::dsp::ProcessSpec& spec)
+        {
+            jassert(spec.numChannels == 1);
+
+            invSampleRate = static_cast<float>(1.0 / spec.sampleRate);
+            setCutoffFrequencyHz(cutoffHz); //g depends on the rate
+
+            snapToNextTarget = true;
+            reset();
+        }
+
+        void reset()
+        {
+            states.fill(SampleType(0.f));
+        }
+
+        void setMode(Mode newMode)
+        {
+            if (newMode == mode)
+                return;
+
+            mode = newMode;
+
+            //output mix of { input, stage 1 .. 4 } and the passband compensation, as juce::dsp::LadderFilter
+            switch (mode)
+            {
+            case Mode::LPF12: mix = { 0.f, 0.f, 1.f, 0.f, 0.f };    compensation = 0.5f; break;
+            case Mode::HPF12: mix = { 1.f, -2.f, 1.f, 0.f, 0.f };   compensation = 0.f;  break;
+            case Mode::BPF12: mix = { 0.f, 0.f, -1.f, 1.f, 0.f };   compensation = 0.5f; break;
+            case Mode::LPF24: mix = { 0.f, 0.f, 0.f, 0.f, 1.f };    compensation = 0.5f; break;
+            case Mode::HPF24: mix = { 1.f, -4.f, 6.f, -4.f, 1.f };  compensation = 0.f;  break;
+            case Mode::BPF24: mix = { 0.f, 0.f, 1.f, -2.f, 1.f };   compensation = 0.5f; break;
+            default: jassertfalse; break;
+            }
+        }
+
+        void setCutoffFrequencyHz(float newCutoffHz)
+        {
+            cutoffHz = newCutoffHz;
+            target.g = FastMath::tanPi(cutoffHz * invSampleRate);
+        }
+
+        /** 0..1, 1 sits at the edge of self-oscillation. */
+        void setResonance(float newResonance)
+        {
+            target.k = 4.f * juce::jmap(juce::jlimit(0.f, 1.f, newResonance), 0.1f, 1.f);
+        }
+
+        /** >= 1, with the same make-up gain as juce::dsp::LadderFilter. */
+        void setDrive(float newDrive)
+        {
+            target.drive = juce::jmax(1.f, newDrive);
+            target.gain = std::pow(target.drive, -2.642f) * 0.6103f + 0.3903f;
+        }
+
+        template <typename ProcessContext>
+        void process(const ProcessContext& context) noexcept
+        {
+            const auto& inputBlock = context.getInputBlock();
+            auto& outputBlock = context.getOutputBlock();
+
+            jassert(inputBlock.getNumChannels() == 1 && outputBlock.getNumChannels() == 1);
+
+            const auto numSamples = outputBlock.getNumSamples();
+            const auto* in = inputBlock.getChannelPointer(0);
+            auto* out = outputBlock.getChannelPointer(0);
+
+            if (context.isBypassed)
+            {
+                if (in != out)
+                    std::copy(in, in + numSamples, out);
+
+                return;
+            }
+
+            if (numSamples == 0)
+                return;
+
+            if (snapToNextTarget)
+            {
+                current = target;
+                snapToNextTarget = false;
+            }
+
+            const auto inv = 1.f / static_cast<float>(numSamples);
+            const Params step{ (target.g - current.g) * inv, (target.k - current.k) * inv,
+                               (target.drive - current.drive) * inv, (target.gain - current.gain) * inv };
+
+            auto p = current;
+            auto& [s1, s2, s3, s4] = states;
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                p.g += step.g;
+                p.k += step.k;
+                p.drive += step.drive;
+                p.gain += step.gain;
+
+                //the only division, G = g / (1 + g) for each one-pole
+                const auto G = p.g / (1.f + p.g);
+                const auto oneMinusG = 1.f - G;
+                const auto G2 = G * G;
+                const auto G4 = G2 * G2;
+
+                //stage 4 output = G^4 * u + sigma, solved for the input u of the loop
+                const auto sigma = s1 * (G2 * G * oneMinusG) + s2 * (G2 * oneMinusG) + s3 * (G * oneMinusG) + s4 * oneMinusG;
+                const auto dx = saturate(in[i] * p.drive) * p.gain;
+                const auto u = saturate((dx * (1.f + p.k * compensation) - sigma * p.k) * (1.f / (1.f + p.k * G4)));
+
+                const auto y1 = onePole(u, s1, G);
+                const auto y2 = onePole(y1, s2, G);
+                const auto y3 = onePole(y2, s3, G);
+                const auto y4 = onePole(y3, s4, G);
+
+                out[i] = u * mix[0] + y1 * mix[1] + y2 * mix[2] + y3 * mix[3] + y4 * mix[4];
+            }
+
+            current = target; //no drift from the increments
+        }
+
+    private:
+        struct Params
+        {
+            float g = 0.f, k = 0.4f, drive = 1.f, gain = 1.f;
+        };
+
+        static SampleType saturate(SampleType x) noexcept
+        {
+            return Traits::map(x, [](float v) { return FastMath::tanh(v); });
+        }
+
+        /** TPT one-pole lowpass, s is the integrator state. */
+        static SampleType onePole(SampleType x, SampleType& s, float G) noexcept
+        {
+            const auto v = (x - s) * G;
+            const auto y = v + s;
+            s = y + v;
+            return y;
+        }
+
+        std::array<SampleType, 4> states;
+        std::array<float, 5> mix{ 0.f, 0.f, 1.f, 0.f, 0.f };
+        float compensation = 0.5f;
+        Mode mode = Mode::LPF12;
+
+        Params current, target;
+        float cutoffHz = 200.f, invSampleRate = 1.f / 44100.f;
+        bool snapToNextTarget = true;
+    };
+}
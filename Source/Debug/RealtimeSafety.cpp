@@ -0,0 +1,385 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "RealtimeSafety.h"
+
+#if PROJECTAUDIO_RT_SAFETY_CHECKS
+
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <fcntl.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+ #include <cstdarg>
+ #include <cerrno>
+ #include <ctime>
+
+ //the hooks run inside malloc, the tls must not allocate on first use
+ #define PROJECTAUDIO_RT_TLS thread_local __attribute__((tls_model("initial-exec")))
+
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void __libc_free(void*);
+}
+#else
+ #define PROJECTAUDIO_RT_TLS thread_local
+#endif
+
+namespace ProjectAudio::RealtimeSafety
+{
+    namespace
+    {
+        PROJECTAUDIO_RT_TLS int realtimeDepth = 0;
+        PROJECTAUDIO_RT_TLS bool insideReport = false;
+
+        std::atomic<int> numViolations{ 0 };
+        std::atomic<Action> action{ Action::logAndContinue };
+
+        void writeToStdErr(const char* text) noexcept
+        {
+           #if JUCE_LINUX
+            //raw syscall, the write() hook must not see our own output
+            [[maybe_unused]] auto written = ::syscall(SYS_write, 2, text, std::strlen(text));
+           #else
+            std::fputs(text, stderr);
+           #endif
+        }
+
+        void printStackTrace() noexcept
+        {
+           #if JUCE_LINUX
+            void* frames[64];
+            auto numFrames = ::backtrace(frames, 64);
+            ::backtrace_symbols_fd(frames, numFrames, 2);
+           #else
+            writeToStdErr(juce::SystemStats::getStackBacktrace().toRawUTF8());
+           #endif
+        }
+    }
+
+    ScopedRealtimeThread::ScopedRealtimeThread() noexcept  { ++realtimeDepth; }
+    ScopedRealtimeThread::~ScopedRealtimeThread() noexcept { --realtimeDepth; }
+
+    void setAction(Action newAction) noexcept { action = newAction; }
+    int getNumViolations() noexcept           { return numViolations.load(); }
+    void resetViolations() noexcept           { numViolations = 0; }
+
+    void reportViolation(const char* what) noexcept
+    {
+        if (realtimeDepth == 0 || insideReport)
+            return;
+
+        insideReport = true; //whatever the report itself does is not reported again
+        ++numViolations;
+
+        writeToStdErr("\n[rt-safety] ");
+        writeToStdErr(what);
+        writeToStdErr(" on the audio thread\n");
+        printStackTrace();
+
+        if (action == Action::abort)
+            std::abort();
+
+        insideReport = false;
+    }
+}
+
+using ProjectAudio::RealtimeSafety::reportViolation;
+
+//==============================================================================
+// operator new/delete, all platforms
+namespace
+{
+    void* rawAlloc(std::size_t size) noexcept
+    {
+       #if JUCE_LINUX
+        return __libc_malloc(size == 0 ? 1 : size); //the malloc hook would report it a second time
+       #else
+        return std::malloc(size == 0 ? 1 : size);
+       #endif
+    }
+
+    void rawFree(void* p) noexcept
+    {
+       #if JUCE_LINUX
+        __libc_free(p);
+       #else
+        std::free(p);
+       #endif
+    }
+
+    void* rawAlignedAlloc(std::size_t size, std::align_val_t alignment) noexcept
+    {
+        const auto align = juce::jmax(sizeof(void*), static_cast<std::size_t>(alignment));
+
+       #if JUCE_LINUX
+        return __libc_memalign(align, size == 0 ? 1 : size);
+       #elif JUCE_WINDOWS
+        return _aligned_malloc(size == 0 ? 1 : size, align);
+       #else
+        void* p = nullptr;
+        return posix_memalign(&p, align, size == 0 ? 1 : size) == 0 ? p : nullptr;
+       #endif
+    }
+
+    void rawAlignedFree(void* p) noexcept
+    {
+       #if JUCE_WINDOWS
+        _aligned_free(p);
+       #else
+        rawFree(p);
+       #endif
+    }
+
+    void* checkedNew(std::size_t size)
+    {
+        reportViolation("operator new");
+
+        if (auto* p = rawAlloc(size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    void* checkedAlignedNew(std::size_t size, std::align_val_t alignment)
+    {
+        reportViolation("operator new (aligned)");
+
+        if (auto* p = rawAlignedAlloc(size, alignment))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    void checkedDelete(void* p) noexcept
+    {
+        if (p != nullptr)
+            reportViolation("operator delete");
+
+        rawFree(p);
+    }
+
+    void checkedAlignedDelete(void* p) noexcept
+    {
+        if (p != nullptr)
+            reportViolation("operator delete (aligned)");
+
+        rawAlignedFree(p);
+    }
+}
+
+void* operator new  (std::size_t size)                                  { return checkedNew(size); }
+void* operator new[](std::size_t size)                                  { return checkedNew(size); }
+void* operator new  (std::size_t size, const std::nothrow_t&) noexcept  { reportViolation("operator new"); return rawAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept  { reportViolation("operator new"); return rawAlloc(size); }
+void* operator new  (std::size_t size, std::align_val_t a)              { return checkedAlignedNew(size, a); }
+void* operator new[](std::size_t size, std::align_val_t a)              { return checkedAlignedNew(size, a); }
+
+void operator delete  (void* p) noexcept                                { checkedDelete(p); }
+void operator delete[](void* p) noexcept                                { checkedDelete(p); }
+void operator delete  (void* p, std::size_t) noexcept                   { checkedDelete(p); }
+void operator delete[](void* p, std::size_t) noexcept                   { checkedDelete(p); }
+void operator delete  (void* p, const std::nothrow_t&) noexcept         { checkedDelete(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept         { checkedDelete(p); }
+void operator delete  (void* p, std::align_val_t) noexcept              { checkedAlignedDelete(p); }
+void operator delete[](void* p, std::align_val_t) noexcept              { checkedAlignedDelete(p); }
+void operator delete  (void* p, std::size_t, std::align_val_t) noexcept { checkedAlignedDelete(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { checkedAlignedDelete(p); }
+
+//==============================================================================
+// C allocator, locks and blocking syscalls, glibc only
+#if JUCE_LINUX
+namespace
+{
+    /** Looks the real symbol up once, without static-local guards (they may take a lock). */
+    template <typename Fn>
+    Fn getNext(std::atomic<void*>& cache, const char* name) noexcept
+    {
+        auto* fn = cache.load(std::memory_order_acquire);
+
+        if (fn == nullptr)
+        {
+            fn = ::dlsym(RTLD_NEXT, name);
+            cache.store(fn, std::memory_order_release);
+        }
+
+        return reinterpret_cast<Fn>(fn);
+    }
+
+    #define PROJECTAUDIO_RT_NEXT(name) \
+        static std::atomic<void*> next_##name{ nullptr }; \
+        auto real_##name = getNext<decltype(&::name)>(next_##name, #name);
+}
+
+extern "C"
+{
+    void* malloc(size_t size)
+    {
+        reportViolation("malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t num, size_t size)
+    {
+        reportViolation("calloc");
+        return __libc_calloc(num, size);
+    }
+
+    void* realloc(void* p, size_t size)
+    {
+        reportViolation("realloc");
+        return __libc_realloc(p, size);
+    }
+
+    void free(void* p)
+    {
+        if (p != nullptr)
+            reportViolation("free");
+
+        __libc_free(p);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size)
+    {
+        reportViolation("posix_memalign");
+
+        if (auto* p = __libc_memalign(alignment, size))
+        {
+            *result = p;
+            return 0;
+        }
+
+        return ENOMEM;
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        reportViolation("aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        reportViolation("memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    //==============================================================================
+    int pthread_mutex_lock(pthread_mutex_t* m)
+    {
+        reportViolation("pthread_mutex_lock");
+        PROJECTAUDIO_RT_NEXT(pthread_mutex_lock)
+        return real_pthread_mutex_lock(m);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* l)
+    {
+        reportViolation("pthread_rwlock_rdlock");
+        PROJECTAUDIO_RT_NEXT(pthread_rwlock_rdlock)
+        return real_pthread_rwlock_rdlock(l);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* l)
+    {
+        reportViolation("pthread_rwlock_wrlock");
+        PROJECTAUDIO_RT_NEXT(pthread_rwlock_wrlock)
+        return real_pthread_rwlock_wrlock(l);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* c, pthread_mutex_t* m)
+    {
+        reportViolation("pthread_cond_wait");
+        PROJECTAUDIO_RT_NEXT(pthread_cond_wait)
+        return real_pthread_cond_wait(c, m);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* c, pthread_mutex_t* m, const struct timespec* t)
+    {
+        reportViolation("pthread_cond_timedwait");
+        PROJECTAUDIO_RT_NEXT(pthread_cond_timedwait)
+        return real_pthread_cond_timedwait(c, m, t);
+    }
+
+    int sem_wait(sem_t* s)
+    {
+        reportViolation("sem_wait");
+        PROJECTAUDIO_RT_NEXT(sem_wait)
+        return real_sem_wait(s);
+    }
+
+    int nanosleep(const struct timespec* req, struct timespec* rem)
+    {
+        reportViolation("nanosleep");
+        PROJECTAUDIO_RT_NEXT(nanosleep)
+        return real_nanosleep(req, rem);
+    }
+
+    int usleep(useconds_t usec)
+    {
+        reportViolation("usleep");
+        PROJECTAUDIO_RT_NEXT(usleep)
+        return real_usleep(usec);
+    }
+
+    ssize_t read(int fd, void* buf, size_t count)
+    {
+        reportViolation("read");
+        PROJECTAUDIO_RT_NEXT(read)
+        return real_read(fd, buf, count);
+    }
+
+    ssize_t write(int fd, const void* buf, size_t count)
+    {
+        reportViolation("write");
+        PROJECTAUDIO_RT_NEXT(write)
+        return real_write(fd, buf, count);
+    }
+
+    int fsync(int fd)
+    {
+        reportViolation("fsync");
+        PROJECTAUDIO_RT_NEXT(fsync)
+        return real_fsync(fd);
+    }
+
+    int open(const char* path, int flags, ...)
+    {
+        reportViolation("open");
+
+        mode_t mode = 0;
+
+        if ((flags & O_CREAT) != 0)
+        {
+            va_list args;
+            va_start(args, flags);
+            mode = static_cast<mode_t>(va_arg(args, int));
+            va_end(args);
+        }
+
+        PROJECTAUDIO_RT_NEXT(open)
+        return real_open(path, flags, mode);
+    }
+}
+
+#undef PROJECTAUDIO_RT_NEXT
+#endif // JUCE_LINUX
+
+#endif // PROJECTAUDIO_RT_SAFETY_CHECKS
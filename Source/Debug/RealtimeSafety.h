@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+    Checking build mode for the audio thread.
+
+    Build with PROJECTAUDIO_RT_SAFETY_CHECKS=1 and every thread inside a
+    ScopedRealtimeThread (processBlock marks itself) reports heap allocations,
+    lock waits and blocking syscalls with a stack trace, or aborts on the first
+    one when the action is set to abort.
+
+    What gets trapped:
+      everywhere        operator new/delete (all forms)
+      Linux executables malloc/calloc/realloc/free/posix_memalign/aligned_alloc,
+                        pthread mutex/rwlock/cond waits, sem_wait, sleeps,
+                        read/write/open/fsync
+
+    The C-level hooks interpose symbols, so they only see every call when the
+    checker is linked into the executable (Tools/OfflineRenderer --rt-stress).
+    In normal builds ScopedRealtimeThread is an empty struct.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#ifndef PROJECTAUDIO_RT_SAFETY_CHECKS
+ #define PROJECTAUDIO_RT_SAFETY_CHECKS 0
+#endif
+
+namespace ProjectAudio::RealtimeSafety
+{
+    enum class Action
+    {
+        logAndContinue, //print the violation and its stack, count it
+        abort           //print, then std::abort()
+    };
+
+    /** Marks the calling thread as realtime until destroyed, nests. */
+    struct ScopedRealtimeThread
+    {
+       #if PROJECTAUDIO_RT_SAFETY_CHECKS
+        ScopedRealtimeThread() noexcept;
+        ~ScopedRealtimeThread() noexcept;
+       #endif
+    };
+
+   #if PROJECTAUDIO_RT_SAFETY_CHECKS
+    void setAction(Action newAction) noexcept;
+    int getNumViolations() noexcept;
+    void resetViolations() noexcept;
+
+    /** Called by the hooks, reports only inside a ScopedRealtimeThread. */
+    void reportViolation(const char* what) noexcept;
+   #endif
+}
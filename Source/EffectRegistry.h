@@ -0,0 +1,386 @@
+/*
+  ==============================================================================
+
+    EffectRegistry.h
+    Every parameter and every effect of the plugin, described once.
+
+    'parameters' are the parameters of one instance of every effect: ID,
+    range, default, unit, the cached pointer it fills and the smoother it
+    feeds. Every instance gets the whole list, instance 0 under the plain IDs
+    and the others with their number appended, after the engine settings, so
+    the IDs and host order from before slots are kept. 'effects' is indexed by
+    DSP_Option: the editor's tab name and the controls it shows. The parameter
+    layout, the cached pointers, the smoother sources and modes,
+    GetParamsForOption and the editor's tab names are all generated from these
+    tables, and the static_asserts below catch a parameter that is missing from
+    a tab or a smoother fed twice when the lists are edited.
+
+    Cached pointers are pointers to members, so the audio thread reads a
+    parameter through a fixed offset; the names are only looked up once, when
+    the processor is constructed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <span>
+#include <variant>
+#include "PluginProcessor.h"
+
+namespace ProjectAudio::EffectRegistry
+{
+    using Processor = ProjectAudioAudioProcessor;
+    using Parameters = Processor::EffectParameters;
+    using Option = Processor::DSP_Option;
+    using Smoothed = Processor::SmoothedParam;
+
+    using FloatMember = juce::AudioParameterFloat* Parameters::*;
+    using ChoiceMember = juce::AudioParameterChoice* Parameters::*;
+    using BoolMember = juce::AudioParameterBool* Parameters::*;
+
+    /** The cached pointer a parameter fills, its type is the parameter's type. */
+    template <typename Owner>
+    using CachedPointerIn = std::variant<juce::AudioParameterFloat* Owner::*, juce::AudioParameterChoice* Owner::*, juce::AudioParameterBool* Owner::*>;
+
+    using CachedPointer = CachedPointerIn<Parameters>;      //one per instance of an effect
+    using EngineCachedPointer = CachedPointerIn<Processor>; //one per processor
+
+    struct FloatRange
+    {
+        float start = 0.f, end = 1.f, interval = 0.f, skew = 1.f;
+    };
+
+    template <typename Pointer>
+    struct Descriptor
+    {
+        std::string_view name;                        //ID and display name, of instance 0
+        Pointer pointer;
+        FloatRange range{};                           //floats only
+        std::span<const std::string_view> choices{};  //choices only
+        float defaultValue = 0.f;                     //value, choice index, or 0 / 1
+        std::string_view unit{};
+        Smoothed smoothed = Smoothed::END_OF_LIST;    //END_OF_LIST: read directly, not smoothed
+        bool logSmoothing = false;                    //frequencies and times ramp in log space, like the ear hears them
+    };
+
+    using ParamDescriptor = Descriptor<CachedPointer>;
+    using EngineParamDescriptor = Descriptor<EngineCachedPointer>;
+
+    struct EffectDescriptor
+    {
+        Option option;
+        std::string_view tabName;
+        std::span<const CachedPointer> controls;      //editor order
+    };
+
+    inline juce::String toString(std::string_view text) { return juce::String(text.data(), text.size()); }
+
+    //==============================================================================
+    namespace Choices
+    {
+        inline constexpr std::array<std::string_view, 4> phaserStages{ "4 Stages", "6 Stages", "8 Stages", "12 Stages" }; //same order as phaserStageCounts
+
+        inline constexpr std::array<std::string_view, 8> chorusVoices{ "1 Voice", "2 Voices", "3 Voices", "4 Voices",
+                                                                        "5 Voices", "6 Voices", "7 Voices", "8 Voices" }; //index + 1 voices
+
+        inline constexpr std::array<std::string_view, 3> overdriveCurve{ "Tanh", "Soft Clip", "Asymmetric Tube" }; //same order as ProjectAudio::ShaperCurve
+
+        inline constexpr std::array<std::string_view, 2> overdriveAntiAliasing{ "Off",
+                                                                                 "ADAA" }; //first-order antiderivative anti-aliasing
+
+        inline constexpr std::array<std::string_view, 4> oversampling{ "1x", "2x", "4x", "8x" };
+
+        inline constexpr std::array<std::string_view, 2> oversamplingFilter{ "IIR (low latency)",    //polyphase allpass half-bands
+                                                                              "FIR (linear phase)" }; //equiripple half-bands
+
+        inline constexpr std::array<std::string_view, 6> ladderFilterMode{ "LPF12", "HPF12", "BPF12", "LPF24", "HPF24", "BPF24" }; //juce::dsp::LadderFilterMode
+
+        inline constexpr std::array<std::string_view, 8> generalFilterMode{ "Peak", "bandpass", "notch", "allpass",
+                                                                             "low shelf", "high shelf", "lowpass", "highpass" }; //generalFilterMode
+
+        inline constexpr std::array<std::string_view, 8> generalFilterSlope{ "12 dB/oct", "24 dB/oct", "36 dB/oct", "48 dB/oct",
+                                                                              "60 dB/oct", "72 dB/oct", "84 dB/oct", "96 dB/oct" }; //index + 1 sections
+
+        inline constexpr std::array<std::string_view, 2> generalFilterPhase{ "Minimum phase (IIR)", "Linear phase (FIR)" };
+
+        inline constexpr std::array<std::string_view, 7> controlRate{ "Auto", "Per sample", "8 samples", "16 samples",
+                                                                       "32 samples", "64 samples", "128 samples" }; //same order as controlIntervals
+
+        inline constexpr std::array<std::string_view, 4> pipelineStages{ "Off", "2 Stages", "3 Stages", "4 Stages" }; //index + 1 stages
+
+        inline constexpr std::array<std::string_view, 4> bands{ "Off", "2 Bands", "3 Bands", "4 Bands" }; //index + 1 bands
+    }
+
+    //==============================================================================
+    /** Layout order of one instance, the order hosts list them in; IDs are part of saved sessions. */
+    inline constexpr std::array parameters
+    {
+        //** Phaser **//
+        ParamDescriptor{ "Phaser RateHz",          &Parameters::PhaserRateHz,        { 0.01f, 2.f, 0.01f },    {}, 0.2f,  "Hz",  Smoothed::PhaserRateHz, true },
+        ParamDescriptor{ "Phaser Depth %",         &Parameters::PhaserDepthPercent,  { 0.01f, 100.f, 0.1f },   {}, 5.f,   "%",   Smoothed::PhaserDepthPercent },
+        ParamDescriptor{ "Phaser Center FreqHz",   &Parameters::PhaserCenterFreqHz,  { 0.01f, 2.f, 0.01f },    {}, 0.2f,  "Hz",  Smoothed::PhaserCenterFreqHz, true },
+        ParamDescriptor{ "Phaser Feedback %",      &Parameters::PhaserFeedbackPercet, { -100.f, 100.f, 0.1f },  {}, 0.f,   "%",   Smoothed::PhaserFeedbackPercent },
+        ParamDescriptor{ "Phaser Mix %",           &Parameters::PhaserMixPercent,    { 0.01f, 100.f, 0.1f },   {}, 5.f,   "%",   Smoothed::PhaserMixPercent },
+        ParamDescriptor{ "Phaser Stages",          &Parameters::PhaserStages,        {}, Choices::phaserStages, 1.f }, //6 stages, like juce::dsp::Phaser
+        ParamDescriptor{ "Phaser Stereo Offset",   &Parameters::PhaserStereoOffset,  { 0.f, 180.f, 1.f },      {}, 0.f,   "deg", Smoothed::PhaserStereoOffset },
+        ParamDescriptor{ "Phaser Bypass",          &Parameters::PhaserBypass },
+
+        //** Chorus **//
+        ParamDescriptor{ "Chorus RateHz",          &Parameters::ChorusRateHz,        { 0.01f, 100.f, 0.01f },  {}, 0.2f,  "Hz",  Smoothed::ChorusRateHz, true },
+        ParamDescriptor{ "Chorus Depth %",         &Parameters::ChorusDepthPercent,  { 0.f, 100.f, 0.1f },     {}, 5.f,   "%",   Smoothed::ChorusDepthPercent },
+        ParamDescriptor{ "Chorus Center Delay Ms", &Parameters::ChorusCenterDelayMs, { 1.f, 100.f, 0.1f },     {}, 7.f,   "ms",  Smoothed::ChorusCenterDelayMs, true },
+        ParamDescriptor{ "Chorus Feedback %",      &Parameters::ChorusFeedbackPercet, { -100.f, 100.f, 0.1f },  {}, 0.f,   "%",   Smoothed::ChorusFeedbackPercent },
+        ParamDescriptor{ "Chorus Mix %",           &Parameters::ChorusMixPercent,    { 0.f, 100.f, 0.1f },     {}, 5.f,   "%",   Smoothed::ChorusMixPercent },
+        ParamDescriptor{ "Chorus Voices",          &Parameters::ChorusVoices,        {}, Choices::chorusVoices, 0.f }, //1 voice, like juce::dsp::Chorus
+        ParamDescriptor{ "Chorus Stereo Spread %", &Parameters::ChorusStereoSpread,  { 0.f, 100.f, 0.1f },     {}, 0.f,   "%",   Smoothed::ChorusStereoSpread },
+        ParamDescriptor{ "Chorus Bypass",          &Parameters::ChorusBypass },
+
+        //** OverDrive **//
+        ParamDescriptor{ "OverDrive Saturation",   &Parameters::OverDriveSaturation, { 1.f, 100.f, 0.1f },     {}, 1.f,   "",    Smoothed::OverdriveSaturation },
+        ParamDescriptor{ "OverDrive Curve",        &Parameters::OverDriveCurve,      {}, Choices::overdriveCurve, 0.f },
+        ParamDescriptor{ "OverDrive Anti-aliasing",&Parameters::OverDriveAntiAliasing,{}, Choices::overdriveAntiAliasing, 1.f },
+        ParamDescriptor{ "OverDrive Oversampling", &Parameters::OverDriveOversampling,{}, Choices::oversampling, 0.f },
+        ParamDescriptor{ "Overdrive Bypass",       &Parameters::OverDriveBypass },
+
+        //** LadderFilter **//
+        ParamDescriptor{ "Ladder Filter Mode",         &Parameters::LadderFilterMode,       {}, Choices::ladderFilterMode, 0.f },
+        ParamDescriptor{ "Ladder Filter Cutoff Hz",    &Parameters::LadderFilterCutoffHz,   { 20.f, 20000.f, 0.1f }, {}, 20000.f, "Hz", Smoothed::LadderFilterCutoffHz, true },
+        ParamDescriptor{ "Ladder Filter Resonance",    &Parameters::LadderFilterResonance,  { 0.f, 100.f, 0.1f },    {}, 0.f,     "%",  Smoothed::LadderFilterResonance },
+        ParamDescriptor{ "Ladder Filter Drive",        &Parameters::LadderFilterDrive,      { 1.f, 100.f, 0.1f },    {}, 1.f,     "",   Smoothed::LadderFilterDrive },
+        ParamDescriptor{ "Ladder Filter Oversampling", &Parameters::LadderFilterOversampling,{}, Choices::oversampling, 0.f },
+        ParamDescriptor{ "Ladder Filter Bypass",       &Parameters::LadderFilterBypass },
+
+        //** GeneralFilter **//
+        ParamDescriptor{ "General Filter Mode",    &Parameters::GeneralFilterMode,   {}, Choices::generalFilterMode, 0.f },
+        ParamDescriptor{ "General Filter Slope",   &Parameters::GeneralFilterSlope,  {}, Choices::generalFilterSlope, 0.f }, //one section, 12 dB/oct
+        ParamDescriptor{ "General Filter Phase",   &Parameters::GeneralFilterPhase,  {}, Choices::generalFilterPhase, 0.f }, //minimum phase, no latency
+        ParamDescriptor{ "General Filter Freq Hz", &Parameters::GeneralFilterFreqHz, { 20.f, 20000.f, 1.f },   {}, 750.f, "Hz",  Smoothed::GeneralFilterFreqHz, true },
+        ParamDescriptor{ "General Filter Quality", &Parameters::GeneralFilterQuality, { 0.01f, 100.f, 0.01f },  {}, 0.72f, "",    Smoothed::GeneralFilterQuality, true },
+        ParamDescriptor{ "General Filter Gain",    &Parameters::GeneralFilterGain,   { -24.f, 24.f, 0.5f },    {}, 0.f,   "dB",  Smoothed::GeneralFilterGain },
+        ParamDescriptor{ "General Filter Bypass",  &Parameters::GeneralFilterBypass },
+
+        //** oversampling filter, shared by the oversampled stages of the instance **//
+        ParamDescriptor{ "Oversampling Filter",    &Parameters::OversamplingFilter,  {}, Choices::oversamplingFilter, 0.f },
+    };
+
+    /** Engine settings, saved with the project, no stage of their own and not on any tab; after instance 0 in the layout. */
+    inline constexpr std::array engineParameters
+    {
+        EngineParamDescriptor{ "Control Rate",         &Processor::ControlRate,          {}, Choices::controlRate, 0.f }, //auto, 64 samples at 44.1 and 48 kHz as before
+        EngineParamDescriptor{ "Reorder Crossfade Ms", &Processor::ReorderCrossfadeMs,   { 0.f, 1000.f, 1.f },     {}, 50.f,  "ms" },
+        EngineParamDescriptor{ "Pipeline Stages",      &Processor::PipelineStages,       {}, Choices::pipelineStages, 0.f }, //off, no added latency
+        EngineParamDescriptor{ "Bands",                &Processor::Bands,                {}, Choices::bands, 0.f },          //off, the chain runs on the whole signal
+        EngineParamDescriptor{ "Crossover Low Hz",     &Processor::CrossoverLowHz,       { 20.f, 20000.f, 1.f, 0.25f }, {}, 200.f,  "Hz" },
+        EngineParamDescriptor{ "Crossover Mid Hz",     &Processor::CrossoverMidHz,       { 20.f, 20000.f, 1.f, 0.25f }, {}, 1000.f, "Hz" },
+        EngineParamDescriptor{ "Crossover High Hz",    &Processor::CrossoverHighHz,      { 20.f, 20000.f, 1.f, 0.25f }, {}, 5000.f, "Hz" },
+    };
+
+    //==============================================================================
+    namespace Controls
+    {
+        inline constexpr std::array<CachedPointer, 8> phaser
+        {
+            &Parameters::PhaserRateHz, &Parameters::PhaserDepthPercent, &Parameters::PhaserCenterFreqHz, &Parameters::PhaserFeedbackPercet,
+            &Parameters::PhaserMixPercent, &Parameters::PhaserStages, &Parameters::PhaserStereoOffset, &Parameters::PhaserBypass
+        };
+
+        inline constexpr std::array<CachedPointer, 8> chorus
+        {
+            &Parameters::ChorusRateHz, &Parameters::ChorusDepthPercent, &Parameters::ChorusCenterDelayMs, &Parameters::ChorusFeedbackPercet,
+            &Parameters::ChorusMixPercent, &Parameters::ChorusVoices, &Parameters::ChorusStereoSpread, &Parameters::ChorusBypass
+        };
+
+        inline constexpr std::array<CachedPointer, 6> overdrive
+        {
+            &Parameters::OverDriveCurve, &Parameters::OverDriveAntiAliasing, &Parameters::OverDriveOversampling, &Parameters::OversamplingFilter,
+            &Parameters::OverDriveSaturation, &Parameters::OverDriveBypass
+        };
+
+        inline constexpr std::array<CachedPointer, 7> ladderFilter
+        {
+            &Parameters::LadderFilterMode, &Parameters::LadderFilterOversampling, &Parameters::OversamplingFilter, &Parameters::LadderFilterCutoffHz,
+            &Parameters::LadderFilterResonance, &Parameters::LadderFilterDrive, &Parameters::LadderFilterBypass
+        };
+
+        inline constexpr std::array<CachedPointer, 7> generalFilter
+        {
+            &Parameters::GeneralFilterMode, &Parameters::GeneralFilterSlope, &Parameters::GeneralFilterPhase, &Parameters::GeneralFilterFreqHz,
+            &Parameters::GeneralFilterQuality, &Parameters::GeneralFilterGain, &Parameters::GeneralFilterBypass
+        };
+    }
+
+    /** Index = DSP_Option. */
+    inline constexpr std::array effects
+    {
+        EffectDescriptor{ Option::Phase,         "PHASER",        Controls::phaser },
+        EffectDescriptor{ Option::Chorus,        "CHORUS",        Controls::chorus },
+        EffectDescriptor{ Option::Overdrive,     "OVERDRIVE",     Controls::overdrive },
+        EffectDescriptor{ Option::LadderFilter,  "LADDERFILTER",  Controls::ladderFilter },
+        EffectDescriptor{ Option::GeneralFilter, "GENERALFILTER", Controls::generalFilter },
+    };
+
+    //==============================================================================
+    namespace detail
+    {
+        constexpr bool effectsFollowOptions()
+        {
+            if (effects.size() != static_cast<size_t>(Option::END_OF_LIST))
+                return false;
+
+            for (size_t i = 0; i < effects.size(); ++i)
+                if (effects[i].option != static_cast<Option>(i))
+                    return false;
+
+            return true;
+        }
+
+        /** Every smoother fed by exactly one float parameter. */
+        constexpr bool smoothersFedOnce()
+        {
+            std::array<int, Processor::numSmoothedParams> sources{};
+
+            for (const auto& param : parameters)
+            {
+                if (param.smoothed == Smoothed::END_OF_LIST)
+                    continue;
+
+                if (! std::holds_alternative<FloatMember>(param.pointer))
+                    return false;
+
+                ++sources[static_cast<size_t>(param.smoothed)];
+            }
+
+            for (auto count : sources)
+                if (count != 1)
+                    return false;
+
+            for (const auto& param : engineParameters)
+                if (param.smoothed != Smoothed::END_OF_LIST)
+                    return false;
+
+            return true;
+        }
+
+        constexpr bool isInLayout(const CachedPointer& pointer)
+        {
+            for (const auto& param : parameters)
+                if (param.pointer == pointer)
+                    return true;
+
+            return false;
+        }
+
+        constexpr bool isControl(const CachedPointer& pointer)
+        {
+            for (const auto& effect : effects)
+                for (const auto& control : effect.controls)
+                    if (control == pointer)
+                        return true;
+
+            return false;
+        }
+
+        /** Every parameter on some tab, every control in the layout. */
+        constexpr bool controlsMatchLayout()
+        {
+            for (const auto& param : parameters)
+                if (! isControl(param.pointer))
+                    return false;
+
+            for (const auto& effect : effects)
+                for (const auto& control : effect.controls)
+                    if (! isInLayout(control))
+                        return false;
+
+            return true;
+        }
+    }
+
+    static_assert(detail::effectsFollowOptions(), "effects must list every DSP_Option once, in enum order");
+    static_assert(detail::smoothersFedOnce(), "every SmoothedParam needs exactly one float parameter, engine settings none");
+    static_assert(detail::controlsMatchLayout(), "every parameter needs a tab, every control a parameter");
+
+    //==============================================================================
+    /** ID and display name of a parameter of an instance: instance 0 keeps the plain name, the others get their number. */
+    inline juce::String getParameterID(const ParamDescriptor& param, size_t instance)
+    {
+        return instance == 0 ? toString(param.name) : toString(param.name) + " " + juce::String(instance + 1);
+    }
+
+    namespace detail
+    {
+        /** Float, choice or bool, whatever the cached pointer points to. */
+        template <typename Pointer>
+        void addParameter(juce::AudioProcessorValueTreeState::ParameterLayout& layout, const Descriptor<Pointer>& param,
+                          const juce::String& name, int versionHint)
+        {
+            const juce::ParameterID id{ name, versionHint };
+
+            switch (param.pointer.index()) //same alternatives as CachedPointerIn
+            {
+            case 0:
+            {
+                const auto& r = param.range;
+                layout.add(std::make_unique<juce::AudioParameterFloat>(id, name,
+                                                                       juce::NormalisableRange<float>(r.start, r.end, r.interval, r.skew),
+                                                                       param.defaultValue, toString(param.unit)));
+                break;
+            }
+
+            case 1:
+            {
+                juce::StringArray choices;
+
+                for (auto choice : param.choices)
+                    choices.add(toString(choice));
+
+                layout.add(std::make_unique<juce::AudioParameterChoice>(id, name, choices, static_cast<int>(param.defaultValue)));
+                break;
+            }
+
+            default:
+                layout.add(std::make_unique<juce::AudioParameterBool>(id, name, param.defaultValue != 0.f));
+                break;
+            }
+        }
+    }
+
+    /** Instance 0, the engine settings, then every further instance: the layout from before slots, extended at the end. */
+    inline juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout(int versionHint)
+    {
+        juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+        for (const auto& param : parameters)
+            detail::addParameter(layout, param, getParameterID(param, 0), versionHint);
+
+        for (const auto& param : engineParameters)
+            detail::addParameter(layout, param, toString(param.name), versionHint);
+
+        for (size_t instance = 1; instance < Processor::maxInstances; ++instance)
+            for (const auto& param : parameters)
+                detail::addParameter(layout, param, getParameterID(param, instance), versionHint);
+
+        return layout;
+    }
+
+    /** One bit per DSP_Option whose tab shows the parameter, the stages it feeds. */
+    constexpr juce::uint32 getStages(const CachedPointer& pointer)
+    {
+        juce::uint32 stages = 0;
+
+        for (const auto& effect : effects)
+            for (const auto& control : effect.controls)
+                stages |= control == pointer ? 1u << static_cast<juce::uint32>(effect.option) : 0u;
+
+        return stages;
+    }
+
+    /** The parameter a cached pointer points to in one instance, once the processor has filled it. */
+    inline juce::RangedAudioParameter* getParameter(const Processor& processor, const CachedPointer& pointer, size_t instance)
+    {
+        const auto& cached = processor.effectParameters[instance];
+        return std::visit([&cached](auto member) -> juce::RangedAudioParameter* { return cached.*member; }, pointer);
+    }
+}
@@ -8,40 +8,61 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "EffectRegistry.h"
 #include <RotarySliderWithLabels.h>
 #include <Utilities.h>
 
-static juce::String GetNameFromDspOption(ProjectAudioAudioProcessor::DSP_Option option)
+//marks the route in front of the tab name: "|| " another branch of the split, "+ " after the branches are mixed
+static juce::String GetRouteMark(ProjectAudioAudioProcessor::DSP_Route route)
 {
-    switch (option)
+    using Route = ProjectAudioAudioProcessor::DSP_Route;
+
+    return route == Route::Branch ? "|| " : route == Route::AfterMix ? "+ " : "";
+}
+
+//marks the band in front of the route: "[1] " runs on the lowest band only, nothing on every band
+static juce::String GetBandMark(ProjectAudioAudioProcessor::DSP_Band band)
+{
+    using Band = ProjectAudioAudioProcessor::DSP_Band;
+
+    return band == Band::All || band >= Band::END_OF_LIST ? juce::String() : "[" + juce::String(static_cast<int>(band)) + "] ";
+}
+
+//the tab name of a slot, the effect's name with the instance number from the second instance on, like the parameter IDs
+static juce::String GetNameFromDspSlot(ProjectAudioAudioProcessor::DSP_Slot slot)
+{
+    if (slot.option != ProjectAudioAudioProcessor::DSP_Option::END_OF_LIST)
     {
-    case ProjectAudioAudioProcessor::DSP_Option::Phase:
-        return "PHASER";
-    case ProjectAudioAudioProcessor::DSP_Option::Chorus:
-        return "CHORUS";
-    case ProjectAudioAudioProcessor::DSP_Option::Overdrive:
-        return "OVERDRIVE";
-    case ProjectAudioAudioProcessor::DSP_Option::LadderFilter:
-        return "LADDERFILTER";
-    case ProjectAudioAudioProcessor::DSP_Option::GeneralFilter:
-        return "GENERALFILTER";
-    case ProjectAudioAudioProcessor::DSP_Option::END_OF_LIST:
-        jassertfalse;
-        break;
-    default:
-        jassertfalse;
+        auto name = ProjectAudio::EffectRegistry::toString(ProjectAudio::EffectRegistry::effects[static_cast<size_t>(slot.option)].tabName);
+        return GetBandMark(slot.band) + GetRouteMark(slot.route) + (slot.instance == 0 ? name : name + " " + juce::String(slot.instance + 1));
     }
-        return "NO SELECTION";
+
+    jassertfalse;
+    return "NO SELECTION";
 }
 
-static ProjectAudioAudioProcessor::DSP_Option GetDspOptionFromName(const juce::String& tabName)
+static ProjectAudioAudioProcessor::DSP_Slot GetDspSlotFromName(const juce::String& tabName)
 {
-    if (tabName == "PHASER") { return ProjectAudioAudioProcessor::DSP_Option::Phase; }
-    else if (tabName == "CHORUS") {return ProjectAudioAudioProcessor::DSP_Option::Chorus;}
-    else if (tabName == "OVERDRIVE") {return  ProjectAudioAudioProcessor::DSP_Option::Overdrive; }
-    else if (tabName == "LADDERFILTER") { return ProjectAudioAudioProcessor::DSP_Option::LadderFilter; }
-    else if (tabName == "GENERALFILTER") { return ProjectAudioAudioProcessor::DSP_Option::GeneralFilter; }
-    return ProjectAudioAudioProcessor::DSP_Option::END_OF_LIST;
+    using Route = ProjectAudioAudioProcessor::DSP_Route;
+    using Band = ProjectAudioAudioProcessor::DSP_Band;
+
+    for (auto band : { Band::All, Band::Band1, Band::Band2, Band::Band3, Band::Band4 })
+    {
+        for (auto route : { Route::Series, Route::Branch, Route::AfterMix })
+        {
+            for (size_t instance = 0; instance < ProjectAudioAudioProcessor::maxInstances; ++instance)
+            {
+                for (const auto& effect : ProjectAudio::EffectRegistry::effects)
+                {
+                    const ProjectAudioAudioProcessor::DSP_Slot slot{ effect.option, instance, route, band };
+
+                    if (tabName == GetNameFromDspSlot(slot)) { return slot; }
+                }
+            }
+        }
+    }
+
+    return {};
 }
 
 //==============================================================================
@@ -94,8 +115,8 @@ void HorizontalConstrainer::checkBounds(juce::Rectangle<int>& bounds, const juce
 
 //==============================================================================
 ExtendedTabBarButton::ExtendedTabBarButton(const juce::String& name, juce::TabbedButtonBar& ownerBar,
-                                          ProjectAudioAudioProcessor::DSP_Option& dspoption) :
-    juce::TabBarButton(name,ownerBar),option(dspoption)
+                                          ProjectAudioAudioProcessor::DSP_Slot& dspslot) :
+    juce::TabBarButton(name,ownerBar),slot(dspslot)
 {
     constrainer = std::make_unique<HorizontalConstrainer>([&ownerBar]() {
         return ownerBar.getLocalBounds();
@@ -147,24 +168,165 @@ void ExtendedTabbedButtonBar::itemDropped(const SourceDetails& dragSourceDetails
     //find the dropped item,and lock the position in
     resized();//re-put all tabs in bar into position
 
-    //FANE:notify of the new order
+    notifyOrderChanged();
+}
+
+//==============================================================================
+void ExtendedTabbedButtonBar::notifyOrderChanged()
+{
+    //FANE:notify of the new order, one slot per tab, the slots after the last tab stay empty
     auto tabs = getTabs();
     ProjectAudioAudioProcessor::DSP_Order newOrder;
 
-    jassert(tabs.size() == newOrder.size());
-    for (size_t i = 0; i < tabs.size(); i++)
+    jassert(tabs.size() <= newOrder.size());
+    for (size_t i = 0; i < tabs.size() && i < newOrder.size(); i++)
     {
         auto tab = tabs[i];            //false????????
         if (auto* etbb = dynamic_cast<ExtendedTabBarButton*>(tab))
         {
-            newOrder[i] = etbb->getOption();
+            newOrder[i] = etbb->getSlot();
         }
     }
 
     listeners.call([newOrder](Listener& l) {
         l.tabOrderChanged(newOrder);
         });
+}
+
+//==============================================================================
+void ExtendedTabbedButtonBar::popupMenuClickOnTab(int tabIndex, const juce::String&)
+{
+    showSlotMenu(tabIndex);
+}
+
+void ExtendedTabbedButtonBar::showSlotMenu(int clickedTabIndex)
+{
+    using Processor = ProjectAudioAudioProcessor;
+
+    //every instance that has no slot yet, the processor built all of them in prepareToPlay
+    auto tabs = getTabs();
+    std::vector<Processor::DSP_Slot> unusedSlots;
+
+    for (size_t instance = 0; instance < Processor::maxInstances; ++instance)
+    {
+        for (const auto& effect : ProjectAudio::EffectRegistry::effects)
+        {
+            const Processor::DSP_Slot slot{ effect.option, instance };
+
+            const auto inChain = std::any_of(tabs.begin(), tabs.end(), [slot](juce::TabBarButton* tab)
+            {
+                auto* etbb = dynamic_cast<ExtendedTabBarButton*>(tab);
+                return etbb != nullptr && etbb->getSlot().RunsSameStage(slot);
+            });
+
+            if (!inChain)
+                unusedSlots.push_back(slot);
+        }
+    }
+
+    juce::PopupMenu addMenu;
+    const auto canAdd = getNumTabs() < static_cast<int>(Processor::maxSlots);
+
+    for (size_t i = 0; i < unusedSlots.size(); ++i)
+    {
+        addMenu.addItem(static_cast<int>(i) + 1, GetNameFromDspSlot(unusedSlots[i]), canAdd);
+    }
+
+    juce::PopupMenu menu;
+    menu.addSubMenu("Add", addMenu, canAdd && !unusedSlots.empty());
 
+    constexpr int removeItemId = 1000; //after every add item
+    auto* clickedTab = getTabButton(clickedTabIndex);
+
+    constexpr int routeItemId = 2000; //+ DSP_Route
+    constexpr int bandItemId = 3000;  //+ DSP_Band
+
+    if (clickedTab != nullptr)
+    {
+        //the last tab stays, an empty chain would leave nothing to click
+        menu.addItem(removeItemId, "Remove " + clickedTab->getButtonText(), getNumTabs() > 1);
+
+        //the first slot always starts the chain, its route does nothing
+        if (auto* etbb = dynamic_cast<ExtendedTabBarButton*>(clickedTab); etbb != nullptr && clickedTabIndex > 0)
+        {
+            using Route = Processor::DSP_Route;
+            const auto route = etbb->getSlot().route;
+
+            menu.addSeparator();
+            menu.addItem(routeItemId + static_cast<int>(Route::Series), "In series", true, route == Route::Series);
+            menu.addItem(routeItemId + static_cast<int>(Route::Branch), "Parallel branch", true, route == Route::Branch);
+            menu.addItem(routeItemId + static_cast<int>(Route::AfterMix), "After the mix", true, route == Route::AfterMix);
+        }
+
+        //only heard while the Bands setting is on
+        if (auto* etbb = dynamic_cast<ExtendedTabBarButton*>(clickedTab))
+        {
+            using Band = Processor::DSP_Band;
+            const auto band = etbb->getSlot().band;
+
+            juce::PopupMenu bandMenu;
+            bandMenu.addItem(bandItemId + static_cast<int>(Band::All), "Every band", true, band == Band::All);
+            bandMenu.addItem(bandItemId + static_cast<int>(Band::Band1), "Band 1 (lowest)", true, band == Band::Band1);
+            bandMenu.addItem(bandItemId + static_cast<int>(Band::Band2), "Band 2", true, band == Band::Band2);
+            bandMenu.addItem(bandItemId + static_cast<int>(Band::Band3), "Band 3", true, band == Band::Band3);
+            bandMenu.addItem(bandItemId + static_cast<int>(Band::Band4), "Band 4 (highest)", true, band == Band::Band4);
+
+            menu.addSeparator();
+            menu.addSubMenu("Band", bandMenu);
+        }
+    }
+
+    auto options = juce::PopupMenu::Options().withTargetComponent(clickedTab != nullptr ? static_cast<juce::Component*>(clickedTab) : this);
+
+    menu.showMenuAsync(options, [safeThis = juce::Component::SafePointer<ExtendedTabbedButtonBar>(this), unusedSlots, clickedTabIndex](int result)
+    {
+        if (safeThis == nullptr || result == 0)
+            return;
+
+        if (result >= bandItemId)
+        {
+            safeThis->setTabBand(clickedTabIndex, static_cast<Processor::DSP_Band>(result - bandItemId));
+        }
+        else if (result >= routeItemId)
+        {
+            safeThis->setTabRoute(clickedTabIndex, static_cast<Processor::DSP_Route>(result - routeItemId));
+        }
+        else if (result == removeItemId)
+        {
+            safeThis->removeTab(clickedTabIndex);
+        }
+        else
+        {
+            safeThis->addTab(GetNameFromDspSlot(unusedSlots[static_cast<size_t>(result - 1)]), juce::Colours::white, -1);
+            safeThis->setCurrentTabIndex(safeThis->getNumTabs() - 1); //show the new slot's controls
+        }
+
+        safeThis->notifyOrderChanged();
+    });
+}
+
+void ExtendedTabbedButtonBar::setTabRoute(int tabIndex, ProjectAudioAudioProcessor::DSP_Route route)
+{
+    if (auto* etbb = dynamic_cast<ExtendedTabBarButton*>(getTabButton(tabIndex)))
+    {
+        auto slot = etbb->getSlot();
+        slot.route = route;
+
+        etbb->setSlot(slot);
+        setTabName(tabIndex, GetNameFromDspSlot(slot)); //the mark shows the route
+    }
+}
+
+void ExtendedTabbedButtonBar::setTabBand(int tabIndex, ProjectAudioAudioProcessor::DSP_Band band)
+{
+    if (auto* etbb = dynamic_cast<ExtendedTabBarButton*>(getTabButton(tabIndex)))
+    {
+        auto slot = etbb->getSlot();
+        slot.band = band;
+
+        etbb->setSlot(slot);
+        setTabName(tabIndex, GetNameFromDspSlot(slot)); //the mark shows the band
+    }
 }
 
 //==============================================================================
@@ -315,6 +477,14 @@ void ExtendedTabbedButtonBar::mouseDown(const juce::MouseEvent& e)
 {
     DBG("etbb MouseDown");
 
+    if (e.mods.isPopupMenu())
+    {
+        if (e.eventComponent == this)
+            showSlotMenu(-1); //on the bar itself, add only, tabs open their menu through popupMenuClickOnTab
+
+        return; //right clicks never drag
+    }
+
     if (auto tabButtonBeingDragged = dynamic_cast<ExtendedTabBarButton*>(e.eventComponent))
     {
         startDragging(tabButtonBeingDragged->getTabbedButtonBar().getTitle(), tabButtonBeingDragged,draggedImage);
@@ -324,8 +494,8 @@ void ExtendedTabbedButtonBar::mouseDown(const juce::MouseEvent& e)
 //==============================================================================
 juce::TabBarButton* ExtendedTabbedButtonBar::createTabButton(const juce::String& tabName, int tabIndex)
 {
-    auto dspOption = GetDspOptionFromName(tabName);
-    auto etbb = std::make_unique<ExtendedTabBarButton>(tabName, *this, dspOption);
+    auto dspSlot = GetDspSlotFromName(tabName);
+    auto etbb = std::make_unique<ExtendedTabBarButton>(tabName, *this, dspSlot);
     etbb->addMouseListener(this, false);
     return etbb.release();   // return a naked ptr
 }
@@ -387,7 +557,7 @@ void ProjectAudioAudioProcessorEditor::timerCallback() //used to store and call
 
     using T = ProjectAudioAudioProcessor::DSP_Order;
     T newOrder;
-    newOrder.fill(ProjectAudioAudioProcessor::DSP_Option::END_OF_LIST);
+    newOrder.fill({});
     auto empty = newOrder;
     while (audioProcessor.storedDspOrderFifo.pull(newOrder))
     {
@@ -404,7 +574,12 @@ void ProjectAudioAudioProcessorEditor::addTabsFromDSPOrder(ProjectAudioAudioProc
     tabbedComponent.clearTabs();
     for (auto v : order)
     {
-        tabbedComponent.addTab(GetNameFromDspOption(v),juce::Colours::white,-1);
+        if (v.option == ProjectAudioAudioProcessor::DSP_Option::END_OF_LIST)
+        {
+            break; //no tabs for the empty slots
+        }
+
+        tabbedComponent.addTab(GetNameFromDspSlot(v),juce::Colours::white,-1);
     }
     rebuildInterface();
     audioProcessor.dsporderFifo.push(order);
@@ -417,8 +592,8 @@ void ProjectAudioAudioProcessorEditor::rebuildInterface()
 
     if (auto etbb = dynamic_cast<ExtendedTabBarButton*>(currentTab))
     {
-        auto option = etbb->getOption();
-        auto params = audioProcessor.GetParamsForOption(option);
+        auto slot = etbb->getSlot();
+        auto params = audioProcessor.GetParamsForOption(slot.option, slot.instance);
 
         jassert(!params.empty());
         dspGUI.rebuildInterface(params);                              
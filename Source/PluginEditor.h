@@ -81,7 +81,15 @@ struct ExtendedTabbedButtonBar : juce::TabbedButtonBar, juce::DragAndDropTarget,
 
     juce::TabBarButton* createTabButton(const juce::String& tabName, int tabIndex) override;
 
+    //** right click: add a slot for an instance that has none, remove the clicked slot or change its route or band **//
+    void popupMenuClickOnTab(int tabIndex, const juce::String& tabName) override;
+
 private:
+    void showSlotMenu(int clickedTabIndex); //-1: clicked beside the tabs
+    void notifyOrderChanged(); //the order of the tabs, left to right, to every listener
+    void setTabRoute(int tabIndex, ProjectAudioAudioProcessor::DSP_Route route);
+    void setTabBand(int tabIndex, ProjectAudioAudioProcessor::DSP_Band band);
+
     //refrac-funcs to simplize funcs above
     juce::TabBarButton* findDraggedItem(const SourceDetails& dragSourceDetails);
     int findDraggedItemIndex(const SourceDetails& dragSourceDetails);
@@ -93,7 +101,7 @@ private:
 
 struct ExtendedTabBarButton : juce::TabBarButton //make one draggable tab
 {
-    ExtendedTabBarButton(const juce::String& name, juce::TabbedButtonBar& ownerBar,ProjectAudioAudioProcessor::DSP_Option& option);
+    ExtendedTabBarButton(const juce::String& name, juce::TabbedButtonBar& ownerBar,ProjectAudioAudioProcessor::DSP_Slot& slot);
 
     juce::ComponentDragger dragger;
 
@@ -103,11 +111,12 @@ struct ExtendedTabBarButton : juce::TabBarButton //make one draggable tab
 
     void mouseDrag(const juce::MouseEvent& e) override;
 
-    ProjectAudioAudioProcessor::DSP_Option getOption() const { return option; };
+    ProjectAudioAudioProcessor::DSP_Slot getSlot() const { return slot; };
+    void setSlot(ProjectAudioAudioProcessor::DSP_Slot newSlot) { slot = newSlot; } //the route and band may change, the stage does not
 
     int getBestTabLength(int depth) override;
 private:
-    ProjectAudioAudioProcessor::DSP_Option option;
+    ProjectAudioAudioProcessor::DSP_Slot slot;
 };
 
 //==============================================================================
@@ -8,64 +8,8 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-
-//** PhaserPramsNameFunc**//
-auto getPhaserRateName() { return juce::String("Phaser RateHz"); }
-auto getPhaserCenterFreqName() { return juce::String("Phaser Center FreqHz");}
-auto getPhaserDepthName() { return juce::String("Phaser Depth %"); }
-auto getPhaserFeedbackName() { return juce::String("Phaser Feedback %"); }
-auto getPhaserMixName() { return juce::String("Phaser Mix %"); }
-auto getPhaserBypassName() { return juce::String("Phaser Bypass"); }
-
-//** ChorusPramsNameFunc**//
-auto getChorusRateName() { return juce::String("Chorus RateHz"); }
-auto getChorusDepthName() { return juce::String("Chorus Depth %"); }
-auto getChorusCenterDelayName() { return juce::String("Chorus Center Delay Ms"); }
-auto getChorusFeedbackName() { return juce::String("Chorus Feedback %"); }
-auto getChorusMixName() { return juce::String("Chorus Mix %"); }
-auto getChorusBypassName() { return juce::String("Chorus Bypass"); }
-
-//** OverDrivePramsNameFunc**//
-auto getOverDriveSaturtationName() { return juce::String("OverDrive Saturation"); }
-auto getOverdriveBypassName() { return juce::String("Overdrive Bypass"); }
-
-//** LadderFilterPramsNameFunc**//
-auto getLadderFilterModeName() { return juce::String("Ladder Filter Mode"); }
-auto getLadderFilterCutoffFrequencyName() { return juce::String("Ladder Filter Cutoff Hz"); }
-auto getLadderFilterResonanceName() { return juce::String("Ladder Filter Resonance"); }
-auto getLadderFilterDriveName() { return juce::String("Ladder Filter Drive"); }
-auto getLadderFilterBypassName() { return juce::String("Ladder Filter Bypass"); }
-
-auto getLadderFilterChoice() {
-    return juce::StringArray{
-    "LPF12",  // low-pass  12 dB/octave
-    "HPF12",  // high-pass 12 dB/octave
-    "BPF12",  // band-pass 12 dB/octave
-    "LPF24",  // low-pass  24 dB/octave
-    "HPF24",  // high-pass 24 dB/octave
-    "BPF24"   // band-pass 24 dB/octave
-    };
-}
-
-//** GeneralFilterPramsNameFunc**//
-auto getGeneralFilterChoice() {
-    return juce::StringArray{
-        "Peak",
-        "bandpass",
-        "notch",
-        "allpass",
-    };
-}
-
-auto getGeneralFilterModeName() { return juce::String("General Filter Mode"); }
-auto getGeneralFilterFreqName() { return juce::String("General Filter Freq Hz"); }
-auto getGeneralFilterQualityName() { return juce::String("General Filter Quality"); }
-auto getGeneralFilterGainName() { return juce::String("General Filter Gain"); }
-auto getGeneralFilterBypassName() { return juce::String("General Filter Bypass"); }
-
-
-
-
+#include "EffectRegistry.h"
+#include "Debug/RealtimeSafety.h"
 
 //==============================================================================
 ProjectAudioAudioProcessor::ProjectAudioAudioProcessor()
@@ -89,137 +33,68 @@ ProjectAudioAudioProcessor::ProjectAudioAudioProcessor()
             DSP_Option::LadderFilter
         } };*/
 
-    for (size_t i = 0; i < static_cast<size_t>(DSP_Option::END_OF_LIST); ++i) //fill Order
+    for (size_t i = 0; i < numStages; ++i) //fill Order, one slot per effect, the remaining slots empty
     {
-        dsporder[i] = static_cast<DSP_Option>(i);
+        dsporder[i] = { static_cast<DSP_Option>(i), 0 };
     }
 
     storedDspOrderFifo.push(dsporder);
 
-    //***********************************PramsPointers and NameFuncPointers and Init*********************************//
-    auto floatParams = std::array{         //floatPrams pointers
-
-        //Phaser
-        &PhaserRateHz,
-        &PhaserDepthPercent,
-        &PhaserCenterFreqHz,
-        &PhaserFeedbackPercet,
-        &PhaserMixPercent,
-
-        //Chorus
-        &ChorusRateHz,
-        &ChorusDepthPercent,
-        &ChorusCenterDelayMs,
-        &ChorusFeedbackPercet,
-        &ChorusMixPercent,
-
-        //OverDrive
-        &OverDriveSaturation,
-
-        //LadderFilter
-        &LadderFilterCutoffHz,
-        &LadderFilterResonance,
-        &LadderFilterDrive,
-
-        //GeneralFilter
-        &GeneralFilterFreqHz,
-        &GeneralFilterQuality,
-        &GeneralFilterGain,
-    };
-
-    auto floatNameFuncs = std::array{          //floatNameFuncs pointers
-        //phaser
-        &getPhaserRateName,
-        &getPhaserDepthName,
-        &getPhaserCenterFreqName,
-        &getPhaserFeedbackName,
-        &getPhaserMixName,
-
-        //chorus
-        &getChorusRateName,
-        &getChorusDepthName,
-        &getChorusCenterDelayName,
-        &getChorusFeedbackName,
-        &getChorusMixName,
-
-        //overdrive
-        &getOverDriveSaturtationName,
-
-        //LadderFilter
-        &getLadderFilterCutoffFrequencyName,
-        &getLadderFilterResonanceName,
-        &getLadderFilterDriveName,
-
-        //GeneralFilter
-        &getGeneralFilterFreqName,
-        &getGeneralFilterQualityName,
-        &getGeneralFilterGainName
-    };
+    //cached pointers, smoother sources, smoothing modes and the stages each parameter dirties, all from the registry
+    parameterStages.assign(static_cast<size_t>(getParameters().size()), 0);
 
-    /*for (size_t i = 0; i < floatParams.size(); i++)
+    for (size_t instance = 0; instance < maxInstances; ++instance)
     {
-        auto ptrToParamPtr = floatParams[i];
+        auto& cached = effectParameters[instance];
 
-        *ptrToParamPtr = dynamic_cast<juce::AudioParameterFloat*>(apvts.getParameter(floatNameFuncs[i]()));
+        for (const auto& param : ProjectAudio::EffectRegistry::parameters)
+        {
+            auto* ranged = apvts.getParameter(ProjectAudio::EffectRegistry::getParameterID(param, instance));
 
-        jassert(*ptrToParamPtr != nullptr);
-    }*/
+            std::visit([&cached, ranged](auto member)
+            {
+                using ParamType = std::remove_reference_t<decltype(cached.*member)>;
+                cached.*member = dynamic_cast<ParamType>(ranged);
+                jassert(cached.*member != nullptr);
+            }, param.pointer);
 
-    initCachedPtrParam<juce::AudioParameterFloat*>(floatParams, floatNameFuncs);
+            const auto stages = ProjectAudio::EffectRegistry::getStages(param.pointer) << (instance * numStages);
 
-    //***********************************PramsPointers and NameFuncPointers and Init*********************************//
+            if (param.smoothed == SmoothedParam::END_OF_LIST)
+            {
+                //choices and toggles jump, a listener bumps their stages' versions
+                parameterStages[static_cast<size_t>(ranged->getParameterIndex())] = stages;
+                ranged->addListener(this);
+                continue;
+            }
 
-    //Add FilterMode Pointers
+            const auto index = instance * numSmoothedParams + static_cast<size_t>(param.smoothed);
+            smoothedParams[index] = cached.*std::get<ProjectAudio::EffectRegistry::FloatMember>(param.pointer);
 
-    auto choiceParams = std::array{
-        &LadderFilterMode,
-        &GeneralFilterMode
-    };
+            if (param.logSmoothing)
+                smoothers.setMode(index, ProjectAudio::SmoothingMode::Multiplicative);
 
-    auto choiceNameFuncs = std::array{
-        &getLadderFilterModeName,
-        &getGeneralFilterModeName
-    };
+            for (size_t stage = 0; stage < stageSmoothers.size(); ++stage)
+            {
+                stageSmoothers[stage][index] = ((stages >> stage) & 1u) != 0;
+            }
+        }
+    }
 
-    /*for (size_t i = 0; i < choiceParams.size(); i++)
+    //engine settings feed no stage
+    for (const auto& param : ProjectAudio::EffectRegistry::engineParameters)
     {
-        auto ptrToParams = choiceParams[i];
-
-        *ptrToParams = dynamic_cast<juce::AudioParameterChoice*>(apvts.getParameter(choiceNameFuncs[i]()));
-
-        jassert(*ptrToParams != nullptr);
-    }*/
-
-    initCachedPtrParam<juce::AudioParameterChoice*>(choiceParams, choiceNameFuncs);
-    
-    //Add Bypass Pointers
-    auto bypassParams = std::array{
-        &PhaserBypass,
-        &ChorusBypass,
-        &OverDriveBypass,
-        &LadderFilterBypass,
-        &GeneralFilterBypass
-    };
-
-    auto bypassNameFuncs = std::array{
-        &getPhaserBypassName,
-        &getChorusBypassName,
-        &getOverdriveBypassName,
-        &getLadderFilterBypassName,
-        &getGeneralFilterBypassName
-    };
+        auto* ranged = apvts.getParameter(ProjectAudio::EffectRegistry::toString(param.name));
 
-    //FANE:OLD CODE
-    //for (size_t i = 0; i < bypassParams.size(); i++)
-    //{
-    //   auto ptrToParams = bypassParams[i];
-
-    //    *ptrToParams = dynamic_cast<juce::AudioParameterBool*>(apvts.getParameter(bypassNameFuncs[i]()));
-
-    //    jassert(*ptrToParams != nullptr);
-    //}
+        std::visit([this, ranged](auto member)
+        {
+            using ParamType = std::remove_reference_t<decltype(this->*member)>;
+            this->*member = dynamic_cast<ParamType>(ranged);
+            jassert(this->*member != nullptr);
+        }, param.pointer);
+    }
 
-    initCachedPtrParam<juce::AudioParameterBool*>(bypassParams, bypassNameFuncs);
+    startTimerHz(10); //latency follows order, bypass and oversampling changes
 }
 
     
@@ -229,6 +104,12 @@ ProjectAudioAudioProcessor::ProjectAudioAudioProcessor()
 
 ProjectAudioAudioProcessor::~ProjectAudioAudioProcessor()
 {
+    stopTimer();
+
+    for (auto* param : getParameters())
+    {
+        param->removeListener(this);
+    }
 }
 
 //==============================================================================
@@ -266,7 +147,8 @@ bool ProjectAudioAudioProcessor::isMidiEffect() const
 
 double ProjectAudioAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    //the idle chain has no slots, while a reorder runs the longer of the two orders rings on
+    return juce::jmax(channelDSP.GetTailLengthSeconds(), shadowDSP.GetTailLengthSeconds());
 }
 
 int ProjectAudioAudioProcessor::getNumPrograms()
@@ -304,94 +186,187 @@ void ProjectAudioAudioProcessor::prepareToPlay (double sampleRate, int samplesPe
     juce::dsp::ProcessSpec spec;
     spec.sampleRate = sampleRate;
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
+    spec.numChannels = static_cast<juce::uint32>(getTotalNumOutputChannels());
+
+    channelDSP.Prepare(spec, dsporder);
+    shadowDSP.Prepare(spec, DSP_Order()); //a reorder never allocates, both chains and every instance exist from here on
 
-    leftChannel.Prepare(spec);
-    rightChannel.Prepare(spec);
+    //first FIRs for this rate, later ones come from the timer
+    linearPhaseParams = {};
+    UpdateLinearPhaseDesigns();
     // Fane:  prepare all DSP
 
-    for (auto smoother : getSmoothers())
+    channelDSP.SetPipelineDepth(GetPipelineDepth());
+    shadowDSP.SetPipelineDepth(GetPipelineDepth());
+    channelDSP.SetNumBands(GetNumBands());
+    shadowDSP.SetNumBands(GetNumBands());
+    channelDSP.SetCrossovers(GetCrossovers());
+    shadowDSP.SetCrossovers(GetCrossovers());
+
+    //no threads until the routing has something to run beside the audio thread
+    workerBlockSize = samplesPerBlock;
+    workerSampleRate = sampleRate;
+    UpdateWorkerDemand();
+
+    activeChain = &channelDSP;
+    standbyChain = &shadowDSP;
+
+    setLatencySamples(channelDSP.GetLatencySamples());
+
+    smoothers.reset(sampleRate, 0.005); //init smoothers with 5ms ramps
+
+    //same control period at every rate, 64 samples at 44.1 and 48 kHz
+    autoControlInterval = juce::nextPowerOfTwo(juce::roundToInt(sampleRate * autoControlPeriodSeconds));
+
+    //one chunk of the standby chain, the chains run whole chunks
+    maxChunkSamples = juce::jmax(1, samplesPerBlock);
+    reorderBuffer.setSize(static_cast<int>(spec.numChannels), maxChunkSamples);
+    playingOrder = dsporder;
+    reordering = false;
+
+    UpdateSmoothersByParams(1, SmootherUpdateMode::initialize); //init smoother by params
+
+    silentInputSamples = 0;
+    asleep = false;
+}
+
+void ProjectAudioAudioProcessor::timerCallback()
+{
+    //FFTs and allocation for the linear-phase FIR stay off the audio thread
+    UpdateLinearPhaseDesigns();
+
+    //hosts expect latency changes from the message thread, never from processBlock
+    //the slots decide which stages count, the idle chain has none and the longer order wins during a reorder
+    const auto latency = juce::jmax(channelDSP.GetLatencySamples(), shadowDSP.GetLatencySamples());
+
+    if (latency != getLatencySamples())
     {
-        smoother->reset(sampleRate, 0.005); //init smoother with 5ms delay
+        setLatencySamples(latency);
     }
 
-    UpdateSmoothersByParams(1, SmootherUpdateMode::initialize); //init smoother by params
+    UpdateWorkerDemand(); //routing, depth and bands move from the audio thread
 }
 
-void ProjectAudioAudioProcessor::UpdateSmoothersByParams(int numSampleToSkip, SmootherUpdateMode init)
+void ProjectAudioAudioProcessor::UpdateLinearPhaseDesigns()
 {
-    auto paramsNeedingSmoother = std::vector{  //get all params
-         PhaserRateHz,
-         PhaserCenterFreqHz,
-         PhaserDepthPercent,
-         PhaserFeedbackPercet,
-         PhaserMixPercent,
-         ChorusRateHz,
-         ChorusDepthPercent,
-         ChorusCenterDelayMs,
-         ChorusFeedbackPercet,
-         ChorusMixPercent,
-         OverDriveSaturation,
-         LadderFilterCutoffHz,
-         LadderFilterResonance,
-         LadderFilterDrive,
-         GeneralFilterFreqHz,
-         GeneralFilterQuality,
-         GeneralFilterGain
-    };
+    const auto sampleRate = getSampleRate();
+
+    if (sampleRate <= 0.0)
+        return; //not prepared yet, prepareToPlay designs the first ones
+
+    for (size_t instance = 0; instance < maxInstances; ++instance)
+    {
+        //designed in either phase mode, so switching to linear phase finds a current FIR
+        const auto& params = effectParameters[instance];
+
+        const LinearPhaseParams design{ params.GeneralFilterMode->getIndex(),
+                                        params.GeneralFilterSlope->getIndex() + 1,
+                                        params.GeneralFilterFreqHz->get(),
+                                        params.GeneralFilterQuality->get(),
+                                        params.GeneralFilterGain->get(),
+                                        sampleRate };
+
+        if (design == linearPhaseParams[instance])
+            continue;
+
+        linearPhaseParams[instance] = design;
+
+        //exact std::tan, this is not the audio thread
+        const auto nyquistSafeHz = juce::jlimit(1.0, sampleRate * 0.499, static_cast<double>(design.freq));
+        const auto g = static_cast<float>(std::tan(juce::MathConstants<double>::pi * nyquistSafeHz / sampleRate));
 
-    auto smoothers = getSmoothers(); //get smoother
+        const auto response = ProjectAudio::SVFCascadeDesign::design(static_cast<ProjectAudio::SVFResponse>(design.mode),
+                                                                     g, design.q, design.gain,
+                                                                     static_cast<size_t>(design.sections));
 
-    jassert(smoothers.size() == paramsNeedingSmoother.size()); 
+        //one design and one FFT however many bands and chains run this instance
+        const auto fir = ProjectAudio::LinearPhaseFilter::makeFir(response, sampleRate);
 
-    for (size_t i = 0; i < smoothers.size(); ++i)
+        channelDSP.LoadLinearPhaseFir(instance, fir);
+        shadowDSP.LoadLinearPhaseFir(instance, fir); //the standby chain is ready whenever a reorder begins
+    }
+}
+
+void ProjectAudioAudioProcessor::UpdateWorkerDemand()
+{
+    //the chains run one after another, the audio thread takes a task of every run() itself
+    const auto tasks = juce::jmax(channelDSP.GetParallelTasks(), shadowDSP.GetParallelTasks());
+    const auto demand = tasks - 1;
+
+    if (demand != workers.getNumWorkers())
+        workers.setDemand(demand, workerBlockSize, workerSampleRate);
+}
+
+void ProjectAudioAudioProcessor::UpdateSmoothersByParams(int numSampleToSkip, SmootherUpdateMode init)
+{
+    //read every atomic once, nothing here allocates
+    std::array<float, numSmoothers> targets;
+
+    for (size_t i = 0; i < numSmoothers; ++i)
     {
-        auto smoother = smoothers[i];
-        auto param = paramsNeedingSmoother[i];
-        if (init == SmootherUpdateMode::initialize)
-        {
-            smoother->setCurrentAndTargetValue(param->get()); //init smoothers
-        }
-        else
+        targets[i] = smoothedParams[i]->get();
+    }
+
+    if (init == SmootherUpdateMode::initialize)
+    {
+        for (size_t i = 0; i < numSmoothers; ++i)
         {
-            smoother->setTargetValue(param->get()); //set smoothers during live playing
+            smoothers.setCurrentAndTargetValue(i, targets[i]); //init smoothers
         }
+    }
+    else
+    {
+        smoothers.setTargetValues(targets); //set smoothers during live playing
+    }
 
-        smoother->skip(numSampleToSkip); //set how many samples need to skip during smoother update
-    }
-}
-
-std::vector<juce::SmoothedValue<float>*> ProjectAudioAudioProcessor::getSmoothers()
-{
-    auto smoothers = std::vector{
-        & phaserRateHzSmoother,
-        & phaserCenterFreqHzSmoother,
-        & phaserDepthPercentSmoother,
-        & phaserFeedbackPercentSmoother,
-        & phaserMixPercentSmoother,
-        & chorusRateHzSmoother,
-        & chorusDepthPercentSmoother,
-        & chorusCenterDelayMsSmoother,
-        & chorusFeedbackPercentSmoother,
-        & chorusMixPercentSmoother,
-        & overdriveSaturationSmoother,
-        & ladderFilterCutoffHzSmoother,
-        & ladderFilterResonanceSmoother,
-        & ladderFilterDriveSmoother,
-        & generalFilterFreqHzSmoother,
-        & generalFilterQualitySmoother,
-        & generalFilterGainSmoother
-    };
+    smoothers.skip(numSampleToSkip); //advance all smoothers in one pass
+}
+
+int ProjectAudioAudioProcessor::GetControlInterval() const
+{
+    const auto interval = controlIntervals[static_cast<size_t>(ControlRate->getIndex())];
+    return interval > 0 ? interval : autoControlInterval;
+}
 
+juce::uint64 ProjectAudioAudioProcessor::GetStageVersion(DSP_Option option, size_t instance) const
+{
+    const auto stage = instance * numStages + static_cast<size_t>(option);
+    return smoothers.getVersion(stageSmoothers[stage]) + stageEvents[stage].load(std::memory_order_relaxed);
+}
+
+void ProjectAudioAudioProcessor::CaptureControlFrame(ControlFrame& frame, int numSamples) const
+{
+    for (size_t i = 0; i < numSmoothers; ++i)
+    {
+        frame.values[i] = smoothers.getCurrentValue(i);
+    }
+
+    for (size_t instance = 0; instance < maxInstances; ++instance)
+    {
+        for (size_t option = 0; option < numStages; ++option)
+        {
+            frame.stageVersions[instance * numStages + option] = GetStageVersion(static_cast<DSP_Option>(option), instance);
+        }
+    }
 
+    frame.numSamples = numSamples;
+}
 
+void ProjectAudioAudioProcessor::parameterValueChanged(int parameterIndex, float)
+{
+    //host automation calls this on the audio thread, the editor on the message thread
+    const auto stages = parameterStages[static_cast<size_t>(parameterIndex)];
 
-    return smoothers; 
+    for (size_t stage = 0; stage < stageEvents.size(); ++stage)
+    {
+        if ((stages >> stage) & 1u)
+            stageEvents[stage].fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
-void ProjectAudioAudioProcessor::MonoChannelDSP::Prepare(const juce::dsp::ProcessSpec& spec) //Fane:MonoChannelDSP prepare
+void ProjectAudioAudioProcessor::MultiChannelDSP::Prepare(const juce::dsp::ProcessSpec& spec) //Fane:MultiChannelDSP prepare
 {
-    jassert(spec.numChannels == 1);
+    jassert(spec.numChannels > 0);
 
     std::vector<juce::dsp::ProcessorBase*> dps
     {
@@ -399,7 +374,8 @@ void ProjectAudioAudioProcessor::MonoChannelDSP::Prepare(const juce::dsp::Proces
         &chorus,
         &overdrive,
         &ladderFilter,
-        &generalFilter
+        &generalFilter,
+        &linearPhaseFilter
     };
 
     for (auto p : dps)
@@ -407,668 +383,1686 @@ void ProjectAudioAudioProcessor::MonoChannelDSP::Prepare(const juce::dsp::Proces
         p->prepare(spec);
         p->reset();
     }
-    overdrive.dsp.setCutoffFrequencyHz(20000.f);
-}
 
+    invSampleRate = static_cast<float>(1.0 / spec.sampleRate);
 
+    //fresh filters, force every setter on the next update
+    ForceFullUpdate();
+    gfMode = generalFilterMode::END_OF_LIST;
+    filterSections = 0;
+    linearPhaseSelected = IsLinearPhase();
 
-void ProjectAudioAudioProcessor::releaseResources()
-{
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
+    //every factor is built here, UpdateOversampling re-prepares the stages at their rate
+    overdriveOversampler.prepare(spec);
+    ladderOversampler.prepare(spec);
+    overdrive.prepare(overdriveOversampler.getMaxProcessSpec()); //reserves the waveshaper's scratch for every factor
+    ladderFilter.prepare(ladderOversampler.getMaxProcessSpec()); //reserves the lane storage for every factor
+    UpdateOversampling();
+
+    for (size_t i = 0; i < bypassFaders.size(); ++i)
+    {
+        bypassFaders[i].prepare(spec, GetMaxStageLatencySamples(static_cast<DSP_Option>(i))); //room to delay the dry path
+        bypassFaders[i].snapTo(!GetProcessState(static_cast<DSP_Option>(i)).bypassed); //no fade on the first block
+    }
 }
 
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool ProjectAudioAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+void ProjectAudioAudioProcessor::MultiChannelDSP::SetUsedStages(juce::uint32 stages)
 {
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-   #endif
+    const auto previous = usedStages.exchange(stages, std::memory_order_relaxed);
 
-    return true;
-  #endif
+    for (size_t i = 0; i < bypassFaders.size(); ++i)
+    {
+        //a removed stage is not processed any more, its fade would never finish
+        //asleep, it is reset and fades in if a slot brings it back
+        if (((previous & ~stages) >> i) & 1u)
+            bypassFaders[i].snapTo(false);
+    }
 }
-#endif  
 
-std::vector<juce::RangedAudioParameter*> ProjectAudioAudioProcessor::GetParamsForOption(ProjectAudioAudioProcessor::DSP_Option option)
+void ProjectAudioAudioProcessor::ChainDSP::Prepare(const juce::dsp::ProcessSpec& spec, const DSP_Order& dsporder)
 {
-    switch (option)
+    SetOrder(dsporder); //before the instances snap their faders to the stages in use
+
+    int maxLatency = 0;
+
+    for (auto& instance : instances) //every instance is built here, whether a slot uses it or not
     {
-    case ProjectAudioAudioProcessor::DSP_Option::Phase:
+        instance.Prepare(spec);
+        maxLatency += instance.GetMaxLatencySamples();
+    }
+
+    //one block per branch, any routing fits without allocating
+    branchBuffer.setSize(static_cast<int>(spec.numChannels * maxSlots), static_cast<int>(spec.maximumBlockSize));
+
+    for (auto& delay : branchDelays)
     {
-        return
-        {
-            PhaserRateHz,
-            PhaserDepthPercent,
-            PhaserCenterFreqHz,
-            PhaserFeedbackPercet,
-            PhaserMixPercent,
-            PhaserBypass,
-        };
-    }
-        
-    case ProjectAudioAudioProcessor::DSP_Option::Chorus:
-    {
-        return
-        {
-            ChorusRateHz,
-            ChorusDepthPercent,
-            ChorusCenterDelayMs,
-            ChorusFeedbackPercet,
-            ChorusMixPercent,
-            ChorusBypass,
-        };
+        delay.prepare(spec, maxLatency); //a branch waits at most for every other stage
     }
 
-    case ProjectAudioAudioProcessor::DSP_Option::Overdrive:
+    //a handoff holds one full block, so every call fits whatever the host's block size
+    sampleRate = spec.sampleRate;
+    pipelineDelay = static_cast<int>(spec.maximumBlockSize);
+    pipelineBuffer.setSize(static_cast<int>(spec.numChannels * maxPipelineDepth), static_cast<int>(spec.maximumBlockSize));
+
+    for (auto& handoff : handoffs)
     {
-        return
-        {
-            OverDriveSaturation,
-            OverDriveBypass,
-        };
+        handoff.prepare(static_cast<int>(spec.numChannels), pipelineDelay);
     }
 
-    case ProjectAudioAudioProcessor::DSP_Option::LadderFilter:
+    pipelineLatency.store(static_cast<int>(pipelineDepth - 1) * pipelineDelay, std::memory_order_relaxed);
+}
+
+void ProjectAudioAudioProcessor::ChainDSP::SetPipelineDepth(size_t depth)
+{
+    depth = juce::jlimit<size_t>(1, maxPipelineDepth, depth);
+
+    if (depth == pipelineDepth)
+        return;
+
+    pipelineDepth = depth;
+
+    for (auto& handoff : handoffs)
     {
-        return
-        {
-            LadderFilterMode,
-            LadderFilterCutoffHz,
-            LadderFilterResonance,
-            LadderFilterDrive,
-            LadderFilterBypass,
-        };
+        handoff.reset(); //the stages start over, what was in flight is dropped
     }
 
-    case ProjectAudioAudioProcessor::DSP_Option::GeneralFilter:
+    pipelineLatency.store(static_cast<int>(pipelineDepth - 1) * pipelineDelay, std::memory_order_relaxed);
+    UpdateParallelTasks();
+}
+
+void ProjectAudioAudioProcessor::ChainDSP::UpdateParallelTasks()
+{
+    //a pipelined split runs its branches on the stage's thread, so only the stages count then
+    size_t tasks = pipelineDepth;
+
+    if (pipelineDepth == 1)
     {
-        return
+        for (size_t i = 0; i < numSplits; ++i)
         {
-            GeneralFilterMode,
-            GeneralFilterFreqHz,
-            GeneralFilterQuality,
-            GeneralFilterGain,
-            GeneralFilterBypass,
-        };
+            tasks = juce::jmax(tasks, splits[i].numBranches);
+        }
     }
 
-    case ProjectAudioAudioProcessor::DSP_Option::END_OF_LIST:
-        jassertfalse;
-        
-    default:
-        jassertfalse;
-    }
-    
-    jassertfalse;
-    return{};
+    parallelTasks.store(static_cast<int>(tasks), std::memory_order_relaxed);
 }
 
-juce::AudioProcessorValueTreeState::ParameterLayout ProjectAudioAudioProcessor::createParameterLayout() //Fane:createPrameterLayout
+void ProjectAudioAudioProcessor::ChainDSP::Restart(const DSP_Order& dsporder)
 {
-    juce::AudioProcessorValueTreeState::ParameterLayout layout;
-    // false code on adding parameter to layout:
-    // layout.add(std::unique_ptr<juce::AudioParameterFloat>
-    // juce::parameterID(name,VersionHint),   VersionHint is used to get old plugins to work
-    // Name,
-    // parameterRange,
-    // defaultvalue,
-    // unitSuffix
-    // );
-    const int versionHint = 1;
+    SetOrder(dsporder);
 
-     /*
-      Phaser:
-      Rate: hz
-      Depth(percent): 0 to 1(00)
-      Center Freq: hz
-      Feedback(percent): -1(00)to 1(00)
-      Mix(percent): 0 to 1(00)
-    */
-    auto name = getPhaserRateName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(   //added PhaserRate
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange<float>(0.01f, 2.f, 0.01f, 1.f),
-        0.2f,
-        "Hz"
-    ));
-
-    //*****************************************************************************************************//
-    name = getPhaserDepthName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(   //added PhaserDepth
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange<float>(0.01f, 100.f, 0.1f, 1.f),
-        5.f,
-        "%"
-    ));
-
-    //*****************************************************************************************************//
-
-    name = getPhaserCenterFreqName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(   //added PhaserCenterFreq
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange<float>(0.01f, 2.f, 0.01f, 1.f),
-        0.2f,
-        "Hz"
-    ));
-
-    //*****************************************************************************************************//
-
-    name = getPhaserFeedbackName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(   //added PhaserFeedback
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange<float>(-100.f, 100.f, 0.1f, 1.f),
-        0.0f,
-        "%"
-    ));
-
-    //*****************************************************************************************************//
-
-    name = getPhaserMixName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(   //added PhaserMix
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange<float>(0.01f, 100.f, 0.1f, 1.f),
-        5.f,
-        "%"
-    ));
-
-    //*****************************************************************************************************//
-    
-    name = getPhaserBypassName();
-    layout.add(std::make_unique<juce::AudioParameterBool>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        false
-    ));
-    //*****************************************************************************************************//
-    //=====================================================================================================//
-     /*
-      Chorus:
-      Rate: hz
-      Depth(percent): 0 to 1(00)
-      Center Delay: 1 to 100ms
-      Feedback(percent): -1(00) to 1(00)
-      Mix(percent): 0 to 1(00)
-    */
-    name = getChorusRateName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange<float>(0.01f, 100.f, 0.01f, 1.f),
-        0.2f,
-        "Hz"
-    ));
-
-    //*****************************************************************************************************//
-
-    name = getChorusDepthName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange<float>(0.0f, 100.f, 0.1f, 1.f),
-        5.f,
-        "%"
-    ));
-
-    //*****************************************************************************************************//
-    name = getChorusCenterDelayName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange<float>(1.f, 100.f, 0.1f, 1.f),
-        7.f,
-        "ms"
-    ));
-
-    //*****************************************************************************************************//
-    name = getChorusFeedbackName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange<float>(-100.f, 100.f, 0.1f, 1.f),
-        0.0f,
-        "%"
-    ));
-
-    //*****************************************************************************************************//
-    name = getChorusMixName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange<float>(0.0f, 100.f, 0.1f, 1.f),
-        5.f,
-        "%"
-    ));
-
-    //*****************************************************************************************************//
-    name = getChorusBypassName();
-    layout.add(std::make_unique<juce::AudioParameterBool>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        false
-    ));
-    //*****************************************************************************************************//
-    //=====================================================================================================//
-     /*
-      OverDrive:
-      drive:1-100
-    */
-    name = getOverDriveSaturtationName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{name,versionHint},
-        name,
-        juce::NormalisableRange(1.f,100.f,0.1f,1.f),
-        1.f,
-        ""
-    ));
-    //*****************************************************************************************************//
-    name = getOverdriveBypassName();
-    layout.add(std::make_unique<juce::AudioParameterBool>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        false
-    ));
-
-    //*****************************************************************************************************//
-    //=====================================================================================================//
-     /*
-    ladder filter:
-    mode: LadderFilterMode enum(int)
-    cutoff:hz
-    resonance: 0 to 1(00)
-    drive: 1 - 100
-    */
-
-    name = getLadderFilterModeName();
-    auto choices = getLadderFilterChoice();
-
-    layout.add(std::make_unique<juce::AudioParameterChoice>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        choices,
-        0
-    ));
-    
+    for (auto& instance : instances)
+    {
+        instance.Restart();
+    }
 
-    //*****************************************************************************************************//
-    name = getLadderFilterCutoffFrequencyName();
+    for (auto& delay : branchDelays)
+    {
+        delay.reset();
+    }
 
-   layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange(20.f, 20000.f, 0.1f, 1.f),
-        20000.f,
-        "Hz"
-    ));
-    
+    for (auto& handoff : handoffs)
+    {
+        handoff.reset();
+    }
+}
 
-    //*****************************************************************************************************//
-    name = getLadderFilterResonanceName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange(0.f, 100.f, 0.1f, 1.f),
-        0.f,
-        "%"
-    ));
-    //*****************************************************************************************************//
-    name = getLadderFilterDriveName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange(1.f, 100.f, 0.1f, 1.f),
-        1.f,
-        ""
-    ));
-
-    //*****************************************************************************************************//
-    name = getLadderFilterBypassName();
-    layout.add(std::make_unique<juce::AudioParameterBool>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        false
-    ));
-    //*****************************************************************************************************//
-    //=====================================================================================================//
-
-    /*
-    * general filter:IIRFilter
-    * Mode: Peak,bandpass,notch,allpass,
-    * freq:20hz - 20,000hz in 1hz steps
-    * Q: 0.01 - 100 in 0.01 steps
-    * gain: -24db to +24db in 0.5db increments
-    */
-    name = getGeneralFilterModeName();
-    choices = getGeneralFilterChoice();
-
-    layout.add(std::make_unique<juce::AudioParameterChoice>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        choices,
-        0
-    ));
-    //*****************************************************************************************************//
-    name = getGeneralFilterFreqName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange(20.f, 20000.f, 1.f, 1.f),
-        750.f,
-        "Hz"
-    ));
-    //*****************************************************************************************************//
-    name = getGeneralFilterQualityName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange(0.01f, 100.f, 0.01f,  1.f),
-        0.72f,
-        ""
-    ));
-    //*****************************************************************************************************//
-    name = getGeneralFilterGainName();
-    layout.add(std::make_unique<juce::AudioParameterFloat>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        juce::NormalisableRange(-24.f, 24.f, 0.5f, 1.f),
-        0.f,
-        "dB"
-    ));
-    //*****************************************************************************************************//
-
-    name = getGeneralFilterBypassName();
-    layout.add(std::make_unique<juce::AudioParameterBool>(
-        juce::ParameterID{ name,versionHint },
-        name,
-        false
-    ));
-
-    //*****************************************************************************************************//
-
-    return layout;
-}
-
-
-
-void ProjectAudioAudioProcessor::MonoChannelDSP::UpdateDSPfromParams()
+void ProjectAudioAudioProcessor::ChainDSP::UpdateDSPfromParams(const ControlFrame& frame)
 {
-    //save/load parameters for each dspOption
-   // 
-   //phaser
-    phaser.dsp.setRate(p.phaserRateHzSmoother.getCurrentValue());
-    phaser.dsp.setDepth(p.phaserDepthPercentSmoother.getCurrentValue() * 0.01f);
-    phaser.dsp.setCentreFrequency(p.phaserCenterFreqHzSmoother.getCurrentValue());
-    phaser.dsp.setFeedback(p.phaserFeedbackPercentSmoother.getCurrentValue() * 0.01f);
-    phaser.dsp.setMix(p.phaserMixPercentSmoother.getCurrentValue() * 0.01f);
+    for (auto& instance : instances) //instances without a slot are asleep and skip their setters
+    {
+        instance.UpdateEngines();
+        instance.UpdateDSPfromParams(frame);
+    }
+}
 
-    //chorus
-    chorus.dsp.setRate(p.chorusRateHzSmoother.getCurrentValue());
-    chorus.dsp.setDepth(p.chorusDepthPercentSmoother.getCurrentValue() * 0.01f);
-    chorus.dsp.setCentreDelay(p.chorusCenterDelayMsSmoother.getCurrentValue());
-    chorus.dsp.setFeedback(p.chorusFeedbackPercentSmoother.getCurrentValue() * 0.01f);
-    chorus.dsp.setMix(p.chorusMixPercentSmoother.getCurrentValue() * 0.01f);
+void ProjectAudioAudioProcessor::ChainDSP::ForceFullUpdate()
+{
+    for (auto& instance : instances)
+    {
+        instance.ForceFullUpdate();
+    }
+}
 
-    //overdrive
-    overdrive.dsp.setDrive(p.overdriveSaturationSmoother.getCurrentValue());
+void ProjectAudioAudioProcessor::ChainDSP::SetOrder(const DSP_Order& dsporder)
+{
+    chainOrder = dsporder;
+    slots = DSP_Order();
 
-    //ladderfilter
-    ladderFilter.dsp.setMode(static_cast<juce::dsp::LadderFilterMode>(p.LadderFilterMode->getIndex()));
-    ladderFilter.dsp.setCutoffFrequencyHz(p.ladderFilterCutoffHzSmoother.getCurrentValue());
-    ladderFilter.dsp.setDrive(p.ladderFilterDriveSmoother.getCurrentValue());
-    ladderFilter.dsp.setResonance(p.ladderFilterResonanceSmoother.getCurrentValue() * 0.01f);
+    //keep the valid slots, each instance of each stage once, in order
+    std::array<juce::uint32, maxInstances> usedStages{};
+    size_t numSlots = 0;
 
-    //save/load parameters for each dspOption
+    for (const auto& slot : dsporder)
+    {
+        if (slot.option == DSP_Option::END_OF_LIST)
+            break;
 
+        const auto bit = 1u << static_cast<juce::uint32>(slot.option);
 
-    //Update GeneralFilter Coefficients
-    //4 choices:Peak,Bandpass,Notch,Allpass
-    auto sampleRate = p.getSampleRate();
-    //**Check whether gfParams changed(for Update Coefficients are pricy) **//
-    auto genMode = p.GeneralFilterMode->getIndex();
-    auto genHz = p.generalFilterFreqHzSmoother.getCurrentValue();
-    auto genQ = p.generalFilterQualitySmoother.getCurrentValue();
-    auto genGain = p.generalFilterGainSmoother.getCurrentValue();
+        if (slot.option > DSP_Option::END_OF_LIST || slot.instance >= maxInstances || (usedStages[slot.instance] & bit) != 0)
+        {
+            jassertfalse;
+            continue;
+        }
 
-    bool filterChanged = false;
+        usedStages[slot.instance] |= bit;
+        slots[numSlots] = slot;
 
-    filterChanged |= (filterFreq != genHz);
-    filterChanged |= (filterQ != genQ);
-    filterChanged |= (filterGain != genGain);
+        if (slot.route >= DSP_Route::END_OF_LIST)
+            slots[numSlots].route = DSP_Route::Series;
 
-    auto updateMode = static_cast<generalFilterMode>(genMode);
-    filterChanged |= (gfMode != updateMode);
-    //**Check whether gfParams changed(for Update Coefficients are pricy) **//
+        ++numSlots;
+    }
 
-    if (filterChanged) //if changed
+    //the graph: Branch opens another branch of the current split, AfterMix closes a split that has more than one
+    numBranches = 0;
+    numSplits = 0;
+
+    for (size_t i = 0; i < numSlots; ++i)
     {
-        //**update stored Values **//
-        gfMode = updateMode;
-        filterFreq = genHz;
-        filterQ = genQ;
-        filterGain = genGain;
-        //**update stored Values **//
+        const auto route = slots[i].route;
+        const auto newSplit = i == 0 || (route == DSP_Route::AfterMix && splits[numSplits - 1].numBranches > 1);
 
-        juce::dsp::IIR::Coefficients<float>::Ptr coefficients; //use struct to switch coefficients
-        switch (gfMode)
-        {
-        case ProjectAudioAudioProcessor::generalFilterMode::Peak:
-        {
-            coefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, filterFreq, filterQ, juce::Decibels::decibelsToGain(filterGain));
-                                                    // Convert gain in decibels (dB) to linear gain factor (for multiplication)
-            break;
-        }
+        if (newSplit)
+            splits[numSplits++] = { numBranches, 0 };
 
-        case ProjectAudioAudioProcessor::generalFilterMode::Bandpass:
+        if (newSplit || route == DSP_Route::Branch)
         {
-            coefficients = juce::dsp::IIR::Coefficients<float>::makeBandPass(sampleRate, filterFreq, filterQ);
-            break;
+            branches[numBranches++] = { i, 0 };
+            ++splits[numSplits - 1].numBranches;
         }
 
-        case ProjectAudioAudioProcessor::generalFilterMode::Notch:
-        {
-            coefficients = juce::dsp::IIR::Coefficients<float>::makeNotch(sampleRate, filterFreq, filterQ);
-            break;
-        }
+        ++branches[numBranches - 1].numSlots;
+    }
 
-        case ProjectAudioAudioProcessor::generalFilterMode::Allpass:
-        {
-            coefficients = juce::dsp::IIR::Coefficients<float>::makeAllPass(sampleRate, filterFreq, filterQ);
-            break;
-        }
+    parallel = numBranches > numSplits;
+    parallelLatency.store(-1, std::memory_order_relaxed); //until the first block measures the branches
+    UpdateParallelTasks();
 
-        case ProjectAudioAudioProcessor::generalFilterMode::END_OF_LIST:
-        {
-            jassertfalse;
-            break;
-        }
+    //where the pipeline may cut: between the slots of a serial run, never inside a split
+    numUnits = 0;
 
-        default:
+    for (size_t i = 0; i < numSplits; ++i)
+    {
+        const auto& split = splits[i];
+
+        if (split.numBranches > 1)
         {
-            jassertfalse;
-            break;
-        }
+            units[numUnits++] = { i, true };
+            continue;
         }
 
-        if (coefficients != nullptr)
+        const auto& branch = branches[split.firstBranch];
+
+        for (size_t slot = branch.firstSlot; slot < branch.firstSlot + branch.numSlots; ++slot)
         {
-            //generalFilter                  // 自定义滤波器对象
-            //    └── dsp                      // 处理单元（juce::dsp::IIR::Filter类型）
-            //    └── coefficients        // 系数对象指针（juce::dsp::IIR::Coefficients::Ptr类型）
-            //    └── coefficients   // 实际存储系数的vector容器（std::vector<float>）
-            //    └── size()    // 获取容器大小的方法
-            //if (generalFilter.dsp.coefficients->coefficients.size() != coefficients->coefficients.size())
-            //{
-           //     jassertfalse;
-            //} Fane:Already tested,no longer needed
-
-            *generalFilter.dsp.coefficients = *coefficients;
-            generalFilter.reset();
+            units[numUnits++] = { slot, false };
         }
     }
+
+    for (size_t i = 0; i < instances.size(); ++i)
+    {
+        instances[i].SetUsedStages(usedStages[i]);
+    }
+
+    //every stage of the first instance once, as before slots: one of the inlined chains
+    std::array<DSP_Option, numStages> options;
+
+    for (size_t i = 0; i < numStages; ++i)
+    {
+        options[i] = slots[i].instance == 0 ? slots[i].option : DSP_Option::END_OF_LIST;
+    }
+
+    const auto onlyFirstInstance = numSlots == numStages && !parallel;
+    permutation = onlyFirstInstance ? ProjectAudio::ChainPermutations::toIndex(options) : MultiChannelDSP::numPermutations;
 }
 
-void ProjectAudioAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) //Fane£ºused to init fifo
+double ProjectAudioAudioProcessor::ChainDSP::GetTailLengthSeconds() const
 {
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
+    //the pipeline hands the last input out this much later
+    double tail = static_cast<double>(pipelineLatency.load(std::memory_order_relaxed)) / sampleRate;
 
-    // In case we have more outputs than inputs, this code clears any output
-    // channels that didn't contain input data, (because these aren't
-    // guaranteed to be empty - they may contain garbage).
-    // This is here to avoid people getting screaming feedback
-    // when they first compile a plugin, but obviously you don't need to keep
+    for (const auto& instance : instances)
+    {
+        tail += instance.GetTailLengthSeconds();
+    }
+
+    return tail;
+}
+
+int ProjectAudioAudioProcessor::ChainDSP::GetLatencySamples() const
+{
+    int latency = pipelineLatency.load(std::memory_order_relaxed);
+
+    //branches of a split overlap in time, the audio thread keeps the longest path
+    if (const auto splitLatency = parallelLatency.load(std::memory_order_relaxed); splitLatency >= 0)
+        return latency + splitLatency;
+
+    for (const auto& instance : instances)
+    {
+        latency += instance.GetLatencySamples();
+    }
+
+    return latency;
+}
+
+void ProjectAudioAudioProcessor::MultibandDSP::Prepare(const juce::dsp::ProcessSpec& spec, const DSP_Order& dsporder)
+{
+    SetOrder(dsporder);
+
+    for (size_t band = 0; band < maxBands; ++band) //every band is built here, whether the band count uses it or not
+    {
+        bands[band].Prepare(spec, bandOrders[band]);
+    }
+
+    int maxLatency = 0;
+
+    for (const auto& instance : bands[0].instances)
+    {
+        maxLatency += instance.GetMaxLatencySamples();
+    }
+
+    splitter.prepare(spec);
+    bandBuffer.setSize(static_cast<int>(spec.numChannels * maxBands), static_cast<int>(spec.maximumBlockSize));
+
+    for (auto& delay : bandDelays)
+    {
+        delay.prepare(spec, maxLatency); //a band waits at most for every stage of another
+    }
+}
+
+void ProjectAudioAudioProcessor::MultibandDSP::Restart(const DSP_Order& dsporder)
+{
+    SetOrder(dsporder);
+    splitter.reset();
+
+    for (size_t band = 0; band < maxBands; ++band)
+    {
+        bands[band].Restart(bandOrders[band]);
+    }
+
+    for (auto& delay : bandDelays)
+    {
+        delay.reset();
+    }
+}
+
+void ProjectAudioAudioProcessor::MultibandDSP::Idle()
+{
+    SetOrder(DSP_Order());
+
+    for (auto& band : bands)
+    {
+        band.Idle();
+    }
+}
+
+void ProjectAudioAudioProcessor::MultibandDSP::UpdateDSPfromParams(const ControlFrame& frame)
+{
+    for (size_t band = 0; band < numBands; ++band)
+    {
+        bands[band].UpdateDSPfromParams(frame);
+    }
+}
+
+void ProjectAudioAudioProcessor::MultibandDSP::ForceFullUpdate()
+{
+    for (auto& band : bands)
+    {
+        band.ForceFullUpdate();
+    }
+}
+
+void ProjectAudioAudioProcessor::MultibandDSP::SetOrder(const DSP_Order& dsporder)
+{
+    chainOrder = dsporder;
+
+    if (numBands == 1)
+    {
+        bandOrders[0] = dsporder;
+
+        for (size_t band = 1; band < maxBands; ++band)
+            bandOrders[band] = DSP_Order();
+
+        return;
+    }
+
+    for (size_t band = 0; band < maxBands; ++band)
+    {
+        auto& order = bandOrders[band];
+        order = DSP_Order();
+
+        size_t numSlots = 0;
+        auto skippedRoute = DSP_Route::Series; //a branch or split the band skips the start of opens on its next slot
+
+        for (const auto& slot : dsporder)
+        {
+            if (slot.option == DSP_Option::END_OF_LIST)
+                break;
+
+            const auto runsOnBand = slot.band == DSP_Band::All || slot.band >= DSP_Band::END_OF_LIST
+                || juce::jmin(static_cast<size_t>(slot.band) - 1, numBands - 1) == band;
+
+            if (!runsOnBand)
+            {
+                if (slot.route < DSP_Route::END_OF_LIST)
+                    skippedRoute = juce::jmax(skippedRoute, slot.route); //AfterMix outranks Branch
+
+                continue;
+            }
+
+            order[numSlots] = slot;
+
+            if (slot.route == DSP_Route::Series)
+                order[numSlots].route = skippedRoute;
+
+            skippedRoute = DSP_Route::Series;
+            ++numSlots;
+        }
+    }
+}
+
+double ProjectAudioAudioProcessor::MultibandDSP::GetTailLengthSeconds() const
+{
+    double tail = 0.0;
+
+    for (const auto& band : bands)
+    {
+        tail = juce::jmax(tail, band.GetTailLengthSeconds());
+    }
+
+    return tail;
+}
+
+int ProjectAudioAudioProcessor::MultibandDSP::GetLatencySamples() const
+{
+    int latency = 0;
+
+    for (const auto& band : bands)
+    {
+        latency = juce::jmax(latency, band.GetLatencySamples());
+    }
+
+    return latency;
+}
+
+void ProjectAudioAudioProcessor::MultibandDSP::LoadLinearPhaseFir(size_t instance, const juce::AudioBuffer<float>& fir)
+{
+    for (auto& band : bands)
+    {
+        band.LoadLinearPhaseFir(instance, fir);
+    }
+}
+
+int ProjectAudioAudioProcessor::MultibandDSP::GetParallelTasks() const
+{
+    //the bands go to the pool on long blocks, their splits and stages on short ones
+    const auto usedBands = static_cast<size_t>(numBandsInUse.load(std::memory_order_relaxed));
+    auto tasks = static_cast<int>(usedBands);
+
+    for (size_t band = 0; band < usedBands; ++band)
+    {
+        tasks = juce::jmax(tasks, bands[band].GetParallelTasks());
+    }
+
+    return tasks;
+}
+
+void ProjectAudioAudioProcessor::MultibandDSP::SetPipelineDepth(size_t depth)
+{
+    for (auto& band : bands)
+    {
+        band.SetPipelineDepth(depth);
+    }
+}
+
+void ProjectAudioAudioProcessor::MultibandDSP::SetNumBands(size_t newNumBands)
+{
+    newNumBands = juce::jlimit<size_t>(1, maxBands, newNumBands);
+
+    if (newNumBands == numBands)
+        return;
+
+    //every band hears different audio from here on, the bands start clean like a new order
+    numBands = newNumBands;
+    numBandsInUse.store(static_cast<int>(numBands), std::memory_order_relaxed);
+    splitter.setNumBands(numBands);
+    Restart(chainOrder);
+}
+
+
+
+void ProjectAudioAudioProcessor::releaseResources()
+{
+    // When playback stops, you can use this as an opportunity to free up any
+    // spare memory, etc.
+    workers.setDemand(0, workerBlockSize, workerSampleRate); //the pool shrinks to what other instances need, prepareToPlay asks again
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool ProjectAudioAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+  #if JucePlugin_IsMidiEffect
+    juce::ignoreUnused (layouts);
+    return true;
+  #else
+    // This is the place where you check if the layout is supported.
+    // In this template code we only support mono or stereo.
+    // Some plugin hosts, such as certain GarageBand versions, will only
+    // load plugins that support stereo bus layouts.
+    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
+
+    // This checks if the input layout matches the output layout
+   #if ! JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+   #endif
+
+    return true;
+  #endif
+}
+#endif  
+
+std::vector<juce::RangedAudioParameter*> ProjectAudioAudioProcessor::GetParamsForOption(ProjectAudioAudioProcessor::DSP_Option option, size_t instance)
+{
+    if (option == DSP_Option::END_OF_LIST || instance >= maxInstances)
+    {
+        jassertfalse;
+        return{};
+    }
+
+    std::vector<juce::RangedAudioParameter*> params;
+
+    for (const auto& control : ProjectAudio::EffectRegistry::effects[static_cast<size_t>(option)].controls)
+    {
+        params.push_back(ProjectAudio::EffectRegistry::getParameter(*this, control, instance));
+    }
+
+    return params;
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout ProjectAudioAudioProcessor::createParameterLayout() //Fane:createPrameterLayout
+{
+    // every parameter, its range, default and unit lives in EffectRegistry::parameters
+    // VersionHint is used to get old plugins to work
+    const int versionHint = 1;
+
+    return ProjectAudio::EffectRegistry::createParameterLayout(versionHint);
+}
+
+
+
+void ProjectAudioAudioProcessor::MultiChannelDSP::Restart()
+{
+    std::array<juce::dsp::ProcessorBase*, 6> stages
+    {
+        &phaser,
+        &chorus,
+        &overdrive,
+        &ladderFilter,
+        &generalFilter,
+        &linearPhaseFilter
+    };
+
+    for (auto* stage : stages)
+    {
+        stage->reset();
+    }
+
+    overdriveOversampler.reset();
+    ladderOversampler.reset();
+
+    //fresh filters, force every setter on the next update
+    ForceFullUpdate();
+    gfMode = generalFilterMode::END_OF_LIST;
+    filterSections = 0;
+    linearPhaseSelected = IsLinearPhase();
+
+    for (size_t i = 0; i < bypassFaders.size(); ++i)
+    {
+        bypassFaders[i].snapTo(!GetProcessState(static_cast<DSP_Option>(i)).bypassed); //no fade on the first block
+    }
+}
+
+void ProjectAudioAudioProcessor::MultiChannelDSP::UpdateDSPfromParams(const ControlFrame& frame, juce::uint32 stages)
+{
+    UpdateBypassStates(stages); //a stage engaging now is reset before it gets its parameters
+
+    auto wants = [stages](DSP_Option option) { return ((stages >> static_cast<juce::uint32>(option)) & 1u) != 0; };
+
+    //save/load parameters for each dspOption, only stages that are awake and whose parameters moved
+    //derived values are computed once and shared by every group of lanes
+   // 
+   //phaser
+    if (wants(DSP_Option::Phase) && ConsumeStageChange(DSP_Option::Phase, frame))
+    {
+        const auto numPhaserStages = phaserStageCounts[static_cast<size_t>(params.PhaserStages->getIndex())];
+        const auto stereoOffset = GetSmoothedValue(frame, SmoothedParam::PhaserStereoOffset) / 360.f; //in LFO cycles
+        const auto rate = GetSmoothedValue(frame, SmoothedParam::PhaserRateHz);
+        const auto depth = GetSmoothedValue(frame, SmoothedParam::PhaserDepthPercent) * 0.01f;
+        const auto centre = GetSmoothedValue(frame, SmoothedParam::PhaserCenterFreqHz);
+        const auto feedback = GetSmoothedValue(frame, SmoothedParam::PhaserFeedbackPercent) * 0.01f;
+        const auto mix = GetSmoothedValue(frame, SmoothedParam::PhaserMixPercent) * 0.01f;
+
+        for (size_t g = 0; g < phaser.dsp.groups.size(); ++g) //one phaser per group of SIMD lanes
+        {
+            auto& lanePhaser = phaser.dsp.groups[g];
+
+            lanePhaser.setRate(rate);
+            lanePhaser.setDepth(depth);
+            lanePhaser.setCentreFrequency(centre);
+            lanePhaser.setFeedback(feedback);
+            lanePhaser.setMix(mix);
+            lanePhaser.setNumStages(numPhaserStages);
+            lanePhaser.setStereoOffset(stereoOffset, g * ProjectAudio::LaneBuffer::numLanes);
+        }
+    }
+
+    //chorus
+    if (wants(DSP_Option::Chorus) && ConsumeStageChange(DSP_Option::Chorus, frame))
+    {
+        chorus.dsp.setRate(GetSmoothedValue(frame, SmoothedParam::ChorusRateHz));
+        chorus.dsp.setDepth(GetSmoothedValue(frame, SmoothedParam::ChorusDepthPercent) * 0.01f);
+        chorus.dsp.setCentreDelay(GetSmoothedValue(frame, SmoothedParam::ChorusCenterDelayMs));
+        chorus.dsp.setFeedback(GetSmoothedValue(frame, SmoothedParam::ChorusFeedbackPercent) * 0.01f);
+        chorus.dsp.setMix(GetSmoothedValue(frame, SmoothedParam::ChorusMixPercent) * 0.01f);
+        chorus.dsp.setNumVoices(static_cast<size_t>(params.ChorusVoices->getIndex()) + 1);
+        chorus.dsp.setStereoSpread(GetSmoothedValue(frame, SmoothedParam::ChorusStereoSpread) * 0.01f);
+    }
+
+    //overdrive, the waveshaper ramps the drive across the sub-block itself
+    if (wants(DSP_Option::Overdrive) && ConsumeStageChange(DSP_Option::Overdrive, frame))
+    {
+        overdrive.dsp.setCurve(static_cast<ProjectAudio::ShaperCurve>(params.OverDriveCurve->getIndex()));
+        overdrive.dsp.setAntiAliasing(params.OverDriveAntiAliasing->getIndex() == 1);
+        overdrive.dsp.setDrive(GetSmoothedValue(frame, SmoothedParam::OverdriveSaturation));
+    }
+
+    //ladderfilter, the ZDF ladder ramps cutoff, resonance and drive across the sub-block itself
+    if (wants(DSP_Option::LadderFilter) && ConsumeStageChange(DSP_Option::LadderFilter, frame))
+    {
+        const auto mode = static_cast<juce::dsp::LadderFilterMode>(params.LadderFilterMode->getIndex());
+        const auto cutoff = GetSmoothedValue(frame, SmoothedParam::LadderFilterCutoffHz);
+        const auto resonance = GetSmoothedValue(frame, SmoothedParam::LadderFilterResonance) * 0.01f;
+        const auto drive = GetSmoothedValue(frame, SmoothedParam::LadderFilterDrive);
+
+        for (auto& ladder : ladderFilter.dsp.groups) //one ladder per group of SIMD lanes
+        {
+            ladder.setMode(mode);
+            ladder.setCutoffFrequencyHz(cutoff);
+            ladder.setResonance(resonance);
+            ladder.setDrive(drive);
+        }
+    }
+
+    //save/load parameters for each dspOption
+
+    if (!wants(DSP_Option::GeneralFilter) || !ConsumeStageChange(DSP_Option::GeneralFilter, frame))
+        return;
+
+    if (linearPhaseSelected)
+        return; //the FIR is designed on the message thread, see UpdateLinearPhaseDesigns
+
+    //Update GeneralFilter Coefficients
+    //8 choices:Peak,Bandpass,Notch,Allpass,LowShelf,HighShelf,Lowpass,Highpass
+    //**Check whether gfParams changed(for Update Coefficients are pricy) **//
+    auto genMode = params.GeneralFilterMode->getIndex();
+    auto genSections = static_cast<size_t>(params.GeneralFilterSlope->getIndex()) + 1;
+    auto genHz = GetSmoothedValue(frame, SmoothedParam::GeneralFilterFreqHz);
+    auto genQ = GetSmoothedValue(frame, SmoothedParam::GeneralFilterQuality);
+    auto genGain = GetSmoothedValue(frame, SmoothedParam::GeneralFilterGain);
+
+    bool filterChanged = false;
+
+    filterChanged |= (filterFreq != genHz);
+    filterChanged |= (filterQ != genQ);
+    filterChanged |= (filterGain != genGain);
+    filterChanged |= (filterSections != genSections);
+
+    auto updateMode = static_cast<generalFilterMode>(genMode);
+    filterChanged |= (gfMode != updateMode);
+    //**Check whether gfParams changed(for Update Coefficients are pricy) **//
+
+    if (filterChanged) //if changed
+    {
+        //**update stored Values **//
+        gfMode = updateMode;
+        filterFreq = genHz;
+        filterQ = genQ;
+        filterGain = genGain;
+        filterSections = genSections;
+        //**update stored Values **//
+
+        //designs are written in place and ramped per sample by the filter, no allocation and no reset
+        auto response = ProjectAudio::SVFResponse::Peak;
+        bool validMode = true;
+
+        switch (gfMode)
+        {
+        case ProjectAudioAudioProcessor::generalFilterMode::Peak:
+        {
+            response = ProjectAudio::SVFResponse::Peak;
+            break;
+        }
+
+        case ProjectAudioAudioProcessor::generalFilterMode::Bandpass:
+        {
+            response = ProjectAudio::SVFResponse::Bandpass;
+            break;
+        }
+
+        case ProjectAudioAudioProcessor::generalFilterMode::Notch:
+        {
+            response = ProjectAudio::SVFResponse::Notch;
+            break;
+        }
+
+        case ProjectAudioAudioProcessor::generalFilterMode::Allpass:
+        {
+            response = ProjectAudio::SVFResponse::Allpass;
+            break;
+        }
+
+        case ProjectAudioAudioProcessor::generalFilterMode::LowShelf:
+        {
+            response = ProjectAudio::SVFResponse::LowShelf;
+            break;
+        }
+
+        case ProjectAudioAudioProcessor::generalFilterMode::HighShelf:
+        {
+            response = ProjectAudio::SVFResponse::HighShelf;
+            break;
+        }
+
+        case ProjectAudioAudioProcessor::generalFilterMode::Lowpass:
+        {
+            response = ProjectAudio::SVFResponse::Lowpass;
+            break;
+        }
+
+        case ProjectAudioAudioProcessor::generalFilterMode::Highpass:
+        {
+            response = ProjectAudio::SVFResponse::Highpass;
+            break;
+        }
+
+        case ProjectAudioAudioProcessor::generalFilterMode::END_OF_LIST:
+        {
+            jassertfalse;
+            validMode = false;
+            break;
+        }
+
+        default:
+        {
+            jassertfalse;
+            validMode = false;
+            break;
+        }
+        }
+
+        if (validMode)
+        {
+            //table tan and polynomial exp2 instead of std::tan / std::pow, see FastMath.h for the error bounds
+            //designed once, every section of every group shares it
+            const auto target = ProjectAudio::SVFCascadeDesign::design(response,
+                                                                       ProjectAudio::FastMath::tanPi(filterFreq * invSampleRate),
+                                                                       filterQ,
+                                                                       filterGain,
+                                                                       filterSections);
+
+            for (auto& laneFilter : generalFilter.dsp.groups) //one cascade per group of SIMD lanes
+            {
+                laneFilter.setTarget(target); //reached by the end of the next sub-block
+            }
+        }
+    }
+}
+
+void ProjectAudioAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) //Fane£ºused to init fifo
+{
+    ProjectAudio::RealtimeSafety::ScopedRealtimeThread realtimeScope; //empty unless PROJECTAUDIO_RT_SAFETY_CHECKS
+    juce::ScopedNoDenormals noDenormals;
+    auto totalNumInputChannels = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    // In case we have more outputs than inputs, this code clears any output
+    // channels that didn't contain input data, (because these aren't
+    // guaranteed to be empty - they may contain garbage).
+    // This is here to avoid people getting screaming feedback
+    // when they first compile a plugin, but obviously you don't need to keep
     // this code if your algorithm always overwrites all the output channels.
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
 
-    leftChannel.UpdateDSPfromParams();//save/load parameters for each dspOption
-    rightChannel.UpdateDSPfromParams();//save/load parameters for each dspOption
+    auto newDSPOrder = DSP_Order();
+    //try pull FIFO
+    while (dsporderFifo.pull(newDSPOrder))
+    {
+#if VERYFY_BYPASS_FUNCTIONALITY
+        jassertfalse;
+#endif
+    }
+
+    //once pull replace dsporder 
+    if (newDSPOrder != DSP_Order())
+    {
+        dsporder = newDSPOrder;
+    }
+
+    //** sleep on silence **//
+    const auto inputIsSilent = buffer.getMagnitude(0, buffer.getNumSamples()) < silenceThreshold;
+    silentInputSamples = inputIsSilent ? silentInputSamples + buffer.getNumSamples() : 0;
+
+    if (asleep)
+    {
+        if (inputIsSilent)
+        {
+            playingOrder = dsporder; //nothing to crossfade in silence
+            buffer.clear(); //tails already decayed below the threshold, nothing to compute
+            return;
+        }
+
+        asleep = false; //signal is back, start from the current parameter values
+        UpdateSmoothersByParams(1, SmootherUpdateMode::initialize);
+    }
+    //** sleep on silence **//
+
+    if (!reordering && dsporder != playingOrder)
+    {
+        BeginReorder(); //a request that arrives mid-switch waits for the switch to end
+    }
+
+    //both chains at the same depth, so a reorder fades between outputs with the same latency
+    activeChain->SetPipelineDepth(GetPipelineDepth());
+    standbyChain->SetPipelineDepth(GetPipelineDepth());
+    activeChain->SetNumBands(GetNumBands());
+    standbyChain->SetNumBands(GetNumBands());
+    activeChain->SetCrossovers(GetCrossovers());
+    standbyChain->SetCrossovers(GetCrossovers());
+
+    //* one control interval per frame, the stages ramp their parameters per sample inside it */
+    auto sampleRemaining = buffer.getNumSamples();
+    auto maxSamplesToProcess = juce::jmin(sampleRemaining, GetControlInterval()); //1 sample up to 128, or auto
+
+    auto block = juce::dsp::AudioBlock<float>(buffer) //get current block that points to the data from buffer
+        .getSubsetChannelBlock(0, static_cast<size_t>(totalNumOutputChannels)); //all channels go through the engine together
+
+    size_t startSample = 0;
+    while (sampleRemaining > 0)
+    {
+        //capture the frames of a whole chunk first, the chains then schedule on its size and not on one interval's
+        size_t numFrames = 0;
+        int chunkSamples = 0;
+
+        while (sampleRemaining > 0 && numFrames < maxControlFrames && chunkSamples < maxChunkSamples)
+        {
+            auto samplesToProcess = juce::jmin(sampleRemaining, maxSamplesToProcess, maxChunkSamples - chunkSamples);
+            //advance each smoother 'SampleToProcess' samples
+            UpdateSmoothersByParams(samplesToProcess, SmootherUpdateMode::liveInRealtime);
+            CaptureControlFrame(controlFrames[numFrames++], samplesToProcess);
+
+            chunkSamples += samplesToProcess;
+            sampleRemaining -= samplesToProcess;
+        }
+
+        //create a sub block from the buffer
+        auto chunk = block.getSubBlock(startSample, static_cast<size_t>(chunkSamples));
+        const auto frames = ControlFrames(controlFrames.data(), numFrames);
+
+        //now process, each slot takes its parameters from a frame right before that frame's sub-block
+        if (reordering)
+            ProcessReorder(chunk, frames);
+        else
+            activeChain->Process(chunk, playingOrder, frames);
+
+        startSample += static_cast<size_t>(chunkSamples);
+    }
+
+    //fall asleep once the input has been silent for longer than the chain rings and nothing is left in the output
+    if (silentInputSamples > 0
+        && buffer.getMagnitude(0, buffer.getNumSamples()) < silenceThreshold
+        && silentInputSamples >= static_cast<juce::int64>(activeChain->GetTailLengthSeconds() * getSampleRate()))
+    {
+        asleep = true;
+
+        if (reordering)
+            FinishReorder(); //both chains are silent, no fade needed
+    }
+}
+
+void ProjectAudioAudioProcessor::BeginReorder()
+{
+    const auto sampleRate = getSampleRate();
+    const auto fade = juce::roundToInt(ReorderCrossfadeMs->get() * 0.001 * sampleRate);
+
+    if (fade <= 0)
+    {
+        playingOrder = dsporder; //instant, clicks like it always did
+        return;
+    }
+
+    //the new order starts clean and runs unheard for as long as the chain rings, up to 100 ms
+    reorderOrder = dsporder;
+    standbyChain->Restart(reorderOrder); //instances the new slots use wake up here, already prepared
+
+    reorderWarmup = juce::roundToInt(juce::jmin(activeChain->GetTailLengthSeconds(), maxReorderWarmupSeconds) * sampleRate);
+    reorderFade = fade;
+    reorderPosition = 0;
+    reordering = true;
+}
+
+void ProjectAudioAudioProcessor::ProcessReorder(juce::dsp::AudioBlock<float> block, ControlFrames frames)
+{
+    const auto numSamples = block.getNumSamples();
+    jassert(numSamples <= static_cast<size_t>(reorderBuffer.getNumSamples()));
+
+    auto standbyBlock = juce::dsp::AudioBlock<float>(reorderBuffer)
+        .getSubsetChannelBlock(0, block.getNumChannels())
+        .getSubBlock(0, numSamples);
+
+    //two full chains for every sample of the switch, warming up or fading: a fixed cost
+    standbyBlock.copyFrom(block);
+    activeChain->Process(block, playingOrder, frames);
+    standbyChain->Process(standbyBlock, reorderOrder, frames);
+
+    //linear, both chains run the same stages on the same input so their outputs are strongly correlated
+    const auto invFade = 1.f / static_cast<float>(reorderFade);
+    const auto fadeStart = reorderPosition + 1 - reorderWarmup; //1 on the last sample of the fade
+
+    for (size_t ch = 0; ch < block.getNumChannels(); ++ch)
+    {
+        auto* out = block.getChannelPointer(ch);
+        const auto* standby = standbyBlock.getChannelPointer(ch);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            const auto gain = juce::jlimit(0.f, 1.f, static_cast<float>(fadeStart + static_cast<int>(i)) * invFade);
+            out[i] += (standby[i] - out[i]) * gain;
+        }
+    }
+
+    reorderPosition += static_cast<int>(numSamples);
+
+    if (reorderPosition >= reorderWarmup + reorderFade)
+        FinishReorder();
+}
+
+void ProjectAudioAudioProcessor::FinishReorder()
+{
+    std::swap(activeChain, standbyChain);
+    playingOrder = reorderOrder;
+    reordering = false;
+
+    standbyChain->Idle(); //the old order stops counting for tail and latency
+}
+
+ProjectAudioAudioProcessor::ProcessState ProjectAudioAudioProcessor::MultiChannelDSP::GetProcessState(DSP_Option option)
+{
+    switch (option)
+    {
+    case DSP_Option::Phase:
+        return { &phaser, IsStageBypassed(DSP_Option::Phase) };
+
+    case DSP_Option::Chorus:
+        return { &chorus, IsStageBypassed(DSP_Option::Chorus) };
+
+    case DSP_Option::Overdrive:
+        return { &overdrive, IsStageBypassed(DSP_Option::Overdrive) };
+
+    case DSP_Option::LadderFilter:
+        return { &ladderFilter, IsStageBypassed(DSP_Option::LadderFilter) };
+
+    case DSP_Option::GeneralFilter:
+    {
+        //a new phase mode fades the running engine out first, UpdateBypassStates switches once it is silent
+        const auto bypassed = IsStageBypassed(DSP_Option::GeneralFilter) || linearPhaseSelected != IsLinearPhase();
+
+        if (linearPhaseSelected)
+            return { &linearPhaseFilter, bypassed };
+
+        return { &generalFilter, bypassed };
+    }
+
+    case DSP_Option::END_OF_LIST:
+        jassertfalse;
+        break;
+
+    default:
+        break;
+    }
+
+    return { nullptr, true };
+}
+
+bool ProjectAudioAudioProcessor::MultiChannelDSP::IsStageBypassed(DSP_Option option) const
+{
+    if (!IsStageUsed(option))
+        return true; //no slot runs it
+
+    switch (option)
+    {
+    case DSP_Option::Phase:
+        return params.PhaserBypass->get() || IsIdentity(option);
+
+    case DSP_Option::Chorus:
+        return params.ChorusBypass->get() || IsIdentity(option);
+
+    case DSP_Option::Overdrive:
+        return params.OverDriveBypass->get() || IsIdentity(option);
+
+    case DSP_Option::LadderFilter:
+        return params.LadderFilterBypass->get() || IsIdentity(option);
+
+    case DSP_Option::GeneralFilter:
+        return params.GeneralFilterBypass->get() || IsIdentity(option);
+
+    case DSP_Option::END_OF_LIST:
+    default:
+        break;
+    }
+
+    return true;
+}
+
+bool ProjectAudioAudioProcessor::MultiChannelDSP::IsIdentity(DSP_Option option) const
+{
+    //only settings whose output is exactly the input, checked on the parameter targets
+    switch (option)
+    {
+    case DSP_Option::Phase: //the range stops at 0.01 % to keep saved values, that little wet is -80 dB and counts as none
+        return params.PhaserMixPercent->get() <= 0.01f;
+
+    case DSP_Option::Chorus:
+        return params.ChorusMixPercent->get() <= 0.f;
+
+    case DSP_Option::GeneralFilter:
+    {
+        const auto mode = static_cast<generalFilterMode>(params.GeneralFilterMode->getIndex());
+        const auto isGainOnly = mode == generalFilterMode::Peak || mode == generalFilterMode::LowShelf || mode == generalFilterMode::HighShelf;
+        return isGainOnly && params.GeneralFilterGain->get() == 0.f;
+    }
+
+    case DSP_Option::Overdrive:    //every curve bends loud signals, even at drive 1
+    case DSP_Option::LadderFilter: //always filters
+    case DSP_Option::END_OF_LIST:
+    default:
+        break;
+    }
+
+    return false;
+}
+
+double ProjectAudioAudioProcessor::MultiChannelDSP::GetTailLengthSeconds() const
+{
+    namespace Tail = ProjectAudio::TailEstimate;
+
+    //stages in series ring for at most the sum of their tails, reads targets so any thread may call it
+    double tail = 0.0;
+
+    if (!IsStageBypassed(DSP_Option::Phase))
+    {
+        tail += Tail::phaser(params.PhaserCenterFreqHz->get(), params.PhaserFeedbackPercet->get() * 0.01,
+                             static_cast<int>(phaserStageCounts[static_cast<size_t>(params.PhaserStages->getIndex())]));
+    }
+
+    if (!IsStageBypassed(DSP_Option::Chorus))
+    {
+        tail += Tail::chorus(params.ChorusCenterDelayMs->get(), params.ChorusDepthPercent->get() * 0.01, params.ChorusFeedbackPercet->get() * 0.01);
+    }
+
+    if (!IsStageBypassed(DSP_Option::Overdrive)
+        && static_cast<ProjectAudio::ShaperCurve>(params.OverDriveCurve->getIndex()) == ProjectAudio::ShaperCurve::AsymmetricTube)
+    {
+        tail += Tail::onePole(ProjectAudio::Waveshaper::dcBlockerHz); //memoryless apart from the DC blocker
+    }
+
+    if (!IsStageBypassed(DSP_Option::LadderFilter))
+    {
+        tail += Tail::ladder(params.LadderFilterCutoffHz->get(), params.LadderFilterResonance->get() * 0.01);
+    }
+
+    if (!IsStageBypassed(DSP_Option::GeneralFilter) && IsLinearPhase())
+    {
+        tail += linearPhaseFilter.dsp.getLengthSeconds() * 0.5; //the half after the centre tap, the latency is added below
+    }
+    else if (!IsStageBypassed(DSP_Option::GeneralFilter))
+    {
+        const auto mode = static_cast<generalFilterMode>(params.GeneralFilterMode->getIndex());
+        const auto numSections = static_cast<size_t>(params.GeneralFilterSlope->getIndex()) + 1;
+        const auto isPeak = mode == generalFilterMode::Peak;
+
+        //sections ring one after another, section 0 has the highest Q
+        const auto sectionQ = ProjectAudio::SVFCascadeDesign::getSectionQ(static_cast<ProjectAudio::SVFResponse>(mode),
+                                                                          params.GeneralFilterQuality->get(), numSections, 0);
+        tail += static_cast<double>(numSections)
+              * Tail::svf(params.GeneralFilterFreqHz->get(), sectionQ,
+                          isPeak ? juce::Decibels::decibelsToGain(params.GeneralFilterGain->get() / static_cast<float>(numSections)) : 1.0f);
+    }
+
+    tail += GetLatencySamples() * static_cast<double>(invSampleRate); //oversampled stages hand the signal out late
+
+    return tail;
+}
+
+int ProjectAudioAudioProcessor::MultiChannelDSP::GetLatencySamples() const
+{
+    //the order does not matter in series, the oversampling filters add up
+    int latency = 0;
+
+    for (size_t i = 0; i < numStages; ++i)
+    {
+        latency += GetStageLatencySamples(static_cast<DSP_Option>(i));
+    }
+
+    return latency;
+}
+
+int ProjectAudioAudioProcessor::MultiChannelDSP::GetStageLatencySamples(DSP_Option option) const
+{
+    //a bypassed stage delays its dry path instead, so toggles never move the host's latency
+    if (!IsStageUsed(option))
+        return 0;
+
+    const auto filterType = static_cast<ProjectAudio::StageOversampler::FilterType>(params.OversamplingFilter->getIndex());
+
+    switch (option)
+    {
+    case DSP_Option::Overdrive:
+        return overdriveOversampler.getLatencyInSamples(static_cast<size_t>(params.OverDriveOversampling->getIndex()), filterType);
+
+    case DSP_Option::LadderFilter:
+        return ladderOversampler.getLatencyInSamples(static_cast<size_t>(params.LadderFilterOversampling->getIndex()), filterType);
+
+    case DSP_Option::GeneralFilter:
+        return linearPhaseSelected ? linearPhaseFilter.dsp.getLatencyInSamples() : 0; //the engine running, not the one requested
+
+    default:
+        return 0;
+    }
+}
+
+int ProjectAudioAudioProcessor::MultiChannelDSP::GetMaxLatencySamples() const
+{
+    int latency = 0;
+
+    for (size_t i = 0; i < numStages; ++i)
+    {
+        latency += GetMaxStageLatencySamples(static_cast<DSP_Option>(i));
+    }
+
+    return latency;
+}
 
+int ProjectAudioAudioProcessor::MultiChannelDSP::GetMaxStageLatencySamples(DSP_Option option) const
+{
+    using FilterType = ProjectAudio::StageOversampler::FilterType;
 
-    auto newDSPOrder = DSP_Order();
-    //try pull FIFO
-    while (dsporderFifo.pull(newDSPOrder))
+    auto longestOf = [](const ProjectAudio::StageOversampler& oversampler)
+    {
+        int longest = 0;
+
+        for (size_t factorLog2 = 0; factorLog2 <= ProjectAudio::StageOversampler::maxFactorLog2; ++factorLog2)
+        {
+            longest = juce::jmax(longest, oversampler.getLatencyInSamples(factorLog2, FilterType::IIR),
+                                          oversampler.getLatencyInSamples(factorLog2, FilterType::FIR));
+        }
+
+        return longest;
+    };
+
+    switch (option)
+    {
+    case DSP_Option::Overdrive:
+        return longestOf(overdriveOversampler);
+
+    case DSP_Option::LadderFilter:
+        return longestOf(ladderOversampler);
+
+    case DSP_Option::GeneralFilter:
+        return linearPhaseFilter.dsp.getLatencyInSamples(); //the FIR's length only follows the sample rate
+
+    default:
+        return 0;
+    }
+}
+
+void ProjectAudioAudioProcessor::MultiChannelDSP::UpdateOversampling()
+{
+    const auto filterType = static_cast<ProjectAudio::StageOversampler::FilterType>(params.OversamplingFilter->getIndex());
+
+    //a new rate re-prepares the stage, both reserved their storage at 8x in Prepare so nothing is allocated
+    if (overdriveOversampler.setConfig(static_cast<size_t>(params.OverDriveOversampling->getIndex()), filterType))
+    {
+        overdrive.prepare(overdriveOversampler.getProcessSpec()); //scratch already reserved at 8x in Prepare
+        InvalidateStage(DSP_Option::Overdrive); //setters again at the new rate
+    }
+
+    if (ladderOversampler.setConfig(static_cast<size_t>(params.LadderFilterOversampling->getIndex()), filterType))
+    {
+        ladderFilter.prepare(ladderOversampler.getProcessSpec()); //lane storage already reserved at 8x in Prepare
+        InvalidateStage(DSP_Option::LadderFilter);
+    }
+}
+
+ProjectAudio::StageOversampler* ProjectAudioAudioProcessor::MultiChannelDSP::GetOversampler(DSP_Option option)
+{
+    switch (option)
+    {
+    case DSP_Option::Overdrive:
+        return &overdriveOversampler;
+
+    case DSP_Option::LadderFilter:
+        return &ladderOversampler;
+
+    case DSP_Option::Phase:         //linear, nothing to alias
+    case DSP_Option::Chorus:
+    case DSP_Option::GeneralFilter:
+    case DSP_Option::END_OF_LIST:
+    default:
+        break;
+    }
+
+    return nullptr;
+}
+
+void ProjectAudioAudioProcessor::MultiChannelDSP::UpdateEngines()
+{
+    //the general filter faded out to change engines: switch, it fades back in from a clean state
+    if (linearPhaseSelected != IsLinearPhase() && IsStageAsleep(DSP_Option::GeneralFilter))
+    {
+        linearPhaseSelected = IsLinearPhase();
+        gfMode = generalFilterMode::END_OF_LIST; //the IIR designs again
+        filterSections = 0;
+        InvalidateStage(DSP_Option::GeneralFilter);
+    }
+
+    UpdateOversampling(); //a new rate re-prepares the stage
+
+    UpdateBypassStates(); //the slots only update their own stages
+}
+
+void ProjectAudioAudioProcessor::MultiChannelDSP::UpdateBypassStates(juce::uint32 stages)
+{
+    for (size_t i = 0; i < bypassFaders.size(); ++i)
+    {
+        if (((stages >> i) & 1u) == 0)
+            continue;
+
+        auto state = GetProcessState(static_cast<DSP_Option>(i));
+
+        bypassFaders[i].setLatency(GetStageLatencySamples(static_cast<DSP_Option>(i))); //follows the oversampling factor
+
+        if (bypassFaders[i].setEngaged(!state.bypassed))
+        {
+            state.Processor->reset(); //re-engaged stages start from clean state
+
+            if (auto* oversampler = GetOversampler(static_cast<DSP_Option>(i)))
+            {
+                oversampler->reset();
+            }
+        }
+    }
+}
+
+bool ProjectAudioAudioProcessor::MultiChannelDSP::ConsumeStageChange(DSP_Option option, const ControlFrame& frame)
+{
+    auto& applied = appliedVersions[static_cast<size_t>(option)];
+
+    if (IsStageAsleep(option))
+    {
+        applied = invalidVersion; //missed updates while asleep, every setter runs once it wakes
+        return false;
+    }
+
+    const auto version = frame.stageVersions[instance * numStages + static_cast<size_t>(option)];
+
+    if (version == applied)
+        return false;
+
+    applied = version;
+    return true;
+}
+
+template <ProjectAudioAudioProcessor::DSP_Option Option>
+void ProjectAudioAudioProcessor::MultiChannelDSP::ProcessStage(juce::dsp::AudioBlock<float> block)
+{
+    //the concrete stage, no virtual call, so the compiler can inline across stages
+    auto processAtRate = [this](juce::dsp::AudioBlock<float> atRate)
+    {
+        const auto context = juce::dsp::ProcessContextReplacing<float>(atRate);
+
+        if constexpr (Option == DSP_Option::Phase)
+            phaser.dsp.process(context);
+        else if constexpr (Option == DSP_Option::Chorus)
+            chorus.dsp.process(context);
+        else if constexpr (Option == DSP_Option::Overdrive)
+            overdrive.dsp.process(context);
+        else if constexpr (Option == DSP_Option::LadderFilter)
+            ladderFilter.dsp.process(context);
+        else if constexpr (Option == DSP_Option::GeneralFilter)
+        {
+            if (linearPhaseSelected)
+                linearPhaseFilter.dsp.process(context);
+            else
+                generalFilter.dsp.process(context);
+        }
+    };
+
+    bypassFaders[static_cast<size_t>(Option)].process(block, [this, &processAtRate](juce::dsp::AudioBlock<float> wet)
+    {
+        if constexpr (Option == DSP_Option::Overdrive)
+            overdriveOversampler.process(wet, processAtRate); //up, stage, down
+        else if constexpr (Option == DSP_Option::LadderFilter)
+            ladderOversampler.process(wet, processAtRate);
+        else
+            processAtRate(wet);
+    });
+}
+
+//every order of the stages, ProcessChain<order...> at the rank of its permutation
+const std::array<ProjectAudioAudioProcessor::MultiChannelDSP::ChainFunction, ProjectAudioAudioProcessor::MultiChannelDSP::numPermutations>
+    ProjectAudioAudioProcessor::MultiChannelDSP::chainTable = ProjectAudio::ChainPermutations::makeTable<numStages>([]<size_t... Order>()
+    {
+        return static_cast<ChainFunction>(&MultiChannelDSP::ProcessChain<Order...>);
+    });
+
+void ProjectAudioAudioProcessor::MultiChannelDSP::ProcessSlot(DSP_Option option, juce::dsp::AudioBlock<float> block)
+{
+    switch (option)
+    {
+    case DSP_Option::Phase:
+        ProcessStage<DSP_Option::Phase>(block);
+        break;
+
+    case DSP_Option::Chorus:
+        ProcessStage<DSP_Option::Chorus>(block);
+        break;
+
+    case DSP_Option::Overdrive:
+        ProcessStage<DSP_Option::Overdrive>(block);
+        break;
+
+    case DSP_Option::LadderFilter:
+        ProcessStage<DSP_Option::LadderFilter>(block);
+        break;
+
+    case DSP_Option::GeneralFilter:
+        ProcessStage<DSP_Option::GeneralFilter>(block);
+        break;
+
+    case DSP_Option::END_OF_LIST:
+    default:
+        jassertfalse;
+        break;
+    }
+}
+
+void ProjectAudioAudioProcessor::MultiChannelDSP::ProcessSlotDynamic(DSP_Option option, juce::dsp::AudioBlock<float> block)
+{
+    //a fully bypassed stage costs nothing, a toggled one crossfades
+    auto* processor = GetProcessState(option).Processor;
+
+    if (processor == nullptr)
     {
+        return;
+    }
+
 #if VERYFY_BYPASS_FUNCTIONALITY
+    if (IsStageBypassed(option))
+    {
         jassertfalse;
+    }
+    if (processor == &generalFilter)
+    {
+        return;
+    }
 #endif
+
+    auto processAtRate = [processor](juce::dsp::AudioBlock<float> atRate)
+    {
+        processor->process(juce::dsp::ProcessContextReplacing<float>(atRate));
+    };
+
+    auto* oversampler = GetOversampler(option);
+
+    bypassFaders[static_cast<size_t>(option)].process(block, [&processAtRate, oversampler](juce::dsp::AudioBlock<float> wet)
+    {
+        if (oversampler != nullptr)
+            oversampler->process(wet, processAtRate); //up, stage, down
+        else
+            processAtRate(wet);
+    });
+}
+
+void ProjectAudioAudioProcessor::MultibandDSP::Process(juce::dsp::AudioBlock<float> block, const DSP_Order& dsporder, ControlFrames frames)
+{
+    if (dsporder != chainOrder)
+    {
+        SetOrder(dsporder);
     }
 
-    //once pull replace dsporder 
-    if (newDSPOrder != DSP_Order())
+    if (numBands == 1)
     {
-        dsporder = newDSPOrder;
+        bands[0].Process(block, bandOrders[0], frames); //no crossover, as before bands
+        return;
     }
 
-    //auto block = juce::dsp::AudioBlock<float>(buffer);
+    ProcessBands(block, frames); //each band runs every frame of the chunk in one task
+}
 
-    //leftChannel.Process(block.getSingleChannelBlock(0), dsporder); //fill pointers
-    //rightChannel.Process(block.getSingleChannelBlock(1), dsporder); //fill pointers
+void ProjectAudioAudioProcessor::MultibandDSP::ProcessBands(juce::dsp::AudioBlock<float> block, ControlFrames frames)
+{
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+    jassert(numSamples <= static_cast<size_t>(bandBuffer.getNumSamples()));
 
-    //* process max 64 samples  at a time */
-    auto sampleRemaining = buffer.getNumSamples();
-    auto maxSamplesToProcess = juce::jmin(sampleRemaining, 64); //get max sample(under 64)
+    std::array<juce::dsp::AudioBlock<float>, maxBands> bandBlocks;
 
-    auto block = juce::dsp::AudioBlock<float>(buffer); //get current block that points to the data from buffer
+    for (size_t band = 0; band < numBands; ++band)
+    {
+        bandBlocks[band] = juce::dsp::AudioBlock<float>(bandBuffer)
+            .getSubsetChannelBlock(band * numChannels, numChannels)
+            .getSubBlock(0, numSamples);
+    }
 
-    size_t startSample = 0;
-    while (sampleRemaining > 0)
+    splitter.process(block, bandBlocks);
+
+    //oversampling and linear phase on one band only would comb where the bands overlap
+    std::array<int, maxBands> latencies{};
+    int maxLatency = 0;
+
+    for (size_t band = 0; band < numBands; ++band)
+    {
+        latencies[band] = bands[band].GetLatencySamples();
+        maxLatency = juce::jmax(maxLatency, latencies[band]);
+    }
+
+    for (size_t band = 0; band < numBands; ++band)
     {
-        auto samplesToProcess = juce::jmin(sampleRemaining, maxSamplesToProcess);
-        //advance each smoother 'SampleToProcess' samples
-        UpdateSmoothersByParams(samplesToProcess, SmootherUpdateMode::liveInRealtime);
+        bandDelays[band].setDelay(maxLatency - latencies[band]);
+    }
 
-        //update dsps
-        leftChannel.UpdateDSPfromParams();
-        rightChannel.UpdateDSPfromParams();
+    //bands run separate chains, so they share no state and can run on any thread
+    //the decision sees the whole chunk, a band's task is a host block's worth of work
+    const auto bandsOnWorkers = numSamples >= ChainDSP::minParallelSamples;
 
-        //create a sub block from the buffer
-        auto subBlock = block.getSubBlock(startSample, samplesToProcess);
+    auto runBand = [this, &bandBlocks, frames, bandsOnWorkers](int index)
+    {
+        const auto band = static_cast<size_t>(index);
 
-        //now process
-        leftChannel.Process(subBlock.getSingleChannelBlock(0), dsporder);
-        leftChannel.Process(subBlock.getSingleChannelBlock(1), dsporder);
+        bands[band].Process(bandBlocks[band], bandOrders[band], frames, !bandsOnWorkers); //splits inside a band stay on its thread
+        bandDelays[band].process(bandBlocks[band]);
+    };
 
-        startSample += samplesToProcess;
-        sampleRemaining -= samplesToProcess;
+    if (bandsOnWorkers)
+    {
+        p.workers.run(numBands, runBand);
+    }
+    else
+    {
+        for (size_t band = 0; band < numBands; ++band)
+            runBand(static_cast<int>(band));
     }
+
+    //the crossover's bands add up to an allpass of the input
+    block.copyFrom(bandBlocks[0]);
+
+    for (size_t band = 1; band < numBands; ++band)
+        block.add(bandBlocks[band]);
 }
 
-void ProjectAudioAudioProcessor::MonoChannelDSP::Process(juce::dsp::AudioBlock<float> block, const DSP_Order& dsporder)
+void ProjectAudioAudioProcessor::ChainDSP::Process(juce::dsp::AudioBlock<float> block, const DSP_Order& dsporder, ControlFrames frames, bool useWorkers)
 {
-    //fill pointers
-    DSP_Pointers dspPointers;
-    dspPointers.fill({});                                     //oldversion: dspPointers.fill(nullptr);
+    //a new order wakes and sleeps instances, nothing is allocated
+    if (dsporder != chainOrder)
+    {
+        SetOrder(dsporder);
+    }
+
+    for (auto& instance : instances)
+    {
+        instance.UpdateEngines(); //cheap when nothing changed, the latencies below hold for the whole chunk
+    }
+
+    if (pipelineDepth > 1)
+    {
+        if (parallel)
+            UpdateBranchDelays();
+
+        ProcessPipelined(block, frames, useWorkers); //whole chunks through the stages, each a host block's worth of work
+        return;
+    }
 
-    for (size_t i = 0; i < dspPointers.size(); ++i)
+    if (permutation < MultiChannelDSP::numPermutations)
     {
-        switch (dsporder[i])
+        ForEachControlFrame(block, frames, [this](juce::dsp::AudioBlock<float> subBlock, const ControlFrame& frame)
         {
-        case DSP_Option::Phase:
-            dspPointers[i].Processor = &phaser;
-            dspPointers[i].bypassed = p.PhaserBypass->get();
-            break;
+            instances[0].UpdateDSPfromParams(frame);
+            instances[0].ProcessPermutation(subBlock, permutation);
+        });
 
-        case DSP_Option::Chorus:
-            dspPointers[i].Processor = &chorus;
-            dspPointers[i].bypassed = p.ChorusBypass->get();
-            break;
+        return;
+    }
 
-        case DSP_Option::Overdrive:
-            dspPointers[i].Processor = &overdrive;
-            dspPointers[i].bypassed = p.OverDriveBypass->get();
-            break;
+    if (!parallel)
+    {
+        //any other list of slots, one switch per slot
+        ForEachControlFrame(block, frames, [this](juce::dsp::AudioBlock<float> subBlock, const ControlFrame& frame)
+        {
+            for (const auto& slot : slots)
+            {
+                if (slot.option == DSP_Option::END_OF_LIST)
+                    break;
 
-        case DSP_Option::LadderFilter:
-            dspPointers[i].Processor = &ladderFilter;
-            dspPointers[i].bypassed = p.LadderFilterBypass->get();
-            break;
+                UpdateSlot(slot, frame);
+                instances[slot.instance].ProcessSlot(slot.option, subBlock);
+            }
+        });
 
-        case DSP_Option::GeneralFilter:
-            dspPointers[i].Processor = &generalFilter;
-            dspPointers[i].bypassed = p.GeneralFilterBypass->get();
-            break;
+        return;
+    }
 
-        case DSP_Option::END_OF_LIST:
-            jassertfalse;
-            break;
+    UpdateBranchDelays(); //oversampling and phase settings move the latencies between chunks
 
-        default:
+    //splits in series over the whole chunk: each slot still sees its frames in order, and a split's branches
+    //get every frame of the chunk in one task, so the pool is worth waking even at the fastest control rate
+    for (size_t i = 0; i < numSplits; ++i)
+    {
+        const auto& split = splits[i];
+
+        if (split.numBranches == 1)
+            ProcessBranch(branches[split.firstBranch], block, frames);
+        else
+            ProcessSplit(split, block, frames, useWorkers);
+    }
+}
+
+void ProjectAudioAudioProcessor::ChainDSP::ProcessBranch(const Branch& branch, juce::dsp::AudioBlock<float> block, ControlFrames frames)
+{
+    ForEachControlFrame(block, frames, [this, &branch](juce::dsp::AudioBlock<float> subBlock, const ControlFrame& frame)
+    {
+        for (size_t i = branch.firstSlot; i < branch.firstSlot + branch.numSlots; ++i)
         {
-            dspPointers[i] = {};
-            break;
-        }
+            UpdateSlot(slots[i], frame);
+            instances[slots[i].instance].ProcessSlot(slots[i].option, subBlock);
         }
+    });
+}
+
+void ProjectAudioAudioProcessor::ChainDSP::ProcessSplit(const Split& split, juce::dsp::AudioBlock<float> block, ControlFrames frames, bool useWorkers)
+{
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+    jassert(numSamples <= static_cast<size_t>(branchBuffer.getNumSamples()));
+
+    auto getBranchBlock = [this, numChannels, numSamples](size_t index)
+    {
+        return juce::dsp::AudioBlock<float>(branchBuffer)
+            .getSubsetChannelBlock(index * numChannels, numChannels)
+            .getSubBlock(0, numSamples);
+    };
+
+    //each branch copies the split's input into its own block, the input stays untouched until the mix
+    //branches run different stages, so they share no state and can run on any thread
+    //blocks are indexed by the branch in the whole chain: pipelined splits run at the same time and must not share one
+    auto runBranch = [this, &split, &block, frames, &getBranchBlock](int index)
+    {
+        const auto branch = split.firstBranch + static_cast<size_t>(index);
+        auto branchBlock = getBranchBlock(branch);
+
+        branchBlock.copyFrom(block);
+        ProcessBranch(branches[branch], branchBlock, frames);
+        branchDelays[branch].process(branchBlock); //in time with the split's longest branch
+    };
+
+    if (useWorkers && numSamples >= minParallelSamples)
+    {
+        p.workers.run(split.numBranches, runBranch); //the audio thread runs branches too, never waits for a wake-up
+    }
+    else
+    {
+        for (size_t i = 0; i < split.numBranches; ++i)
+            runBranch(static_cast<int>(i));
     }
 
-    //now process
-    
-    auto context = juce::dsp::ProcessContextReplacing<float>(block);
+    //equal parts, so branches that pass the signal through leave it as it was
+    block.copyFrom(getBranchBlock(split.firstBranch));
+
+    for (size_t i = 1; i < split.numBranches; ++i)
+        block.add(getBranchBlock(split.firstBranch + i));
 
-    for (size_t i = 0; i < dspPointers.size(); ++i)
+    block.multiplyBy(1.f / static_cast<float>(split.numBranches));
+}
+
+void ProjectAudioAudioProcessor::ChainDSP::ProcessUnit(const PipelineUnit& unit, juce::dsp::AudioBlock<float> block, ControlFrames frames)
+{
+    if (unit.isSplit)
+    {
+        ProcessSplit(splits[unit.index], block, frames, false); //already on the pool, only the audio thread may run() it
+        return;
+    }
+
+    const auto& slot = slots[unit.index];
+
+    ForEachControlFrame(block, frames, [this, &slot](juce::dsp::AudioBlock<float> subBlock, const ControlFrame& frame)
+    {
+        UpdateSlot(slot, frame);
+        instances[slot.instance].ProcessSlot(slot.option, subBlock);
+    });
+}
+
+void ProjectAudioAudioProcessor::ChainDSP::ProcessPipelined(juce::dsp::AudioBlock<float> block, ControlFrames frames, bool useWorkers)
+{
+    const auto numChannels = block.getNumChannels();
+    const auto numSamples = block.getNumSamples();
+    jassert(numSamples <= static_cast<size_t>(pipelineDelay));
+
+    auto getStageBlock = [this, numChannels, numSamples](size_t stage)
     {
-        if (dspPointers[i].Processor != nullptr)
+        return juce::dsp::AudioBlock<float>(pipelineBuffer)
+            .getSubsetChannelBlock(stage * numChannels, numChannels)
+            .getSubBlock(0, numSamples);
+    };
+
+    //stage k takes the audio stage k - 1 handed off on an earlier call, so all of them run at once:
+    //each touches only its own slots, its block and the two ends of its handoffs
+    //a handoff holds one prepared block and a call moves a whole chunk, so the latency buys a host block of overlap
+    auto runStage = [this, &block, frames, &getStageBlock](int index)
+    {
+        const auto stage = static_cast<size_t>(index);
+        auto stageBlock = getStageBlock(stage);
+
+        if (stage == 0)
+            stageBlock.copyFrom(block);
+        else
+            handoffs[stage - 1].read(stageBlock);
+
+        //the units split evenly by count, not by cost
+        for (size_t i = stage * numUnits / pipelineDepth; i < (stage + 1) * numUnits / pipelineDepth; ++i)
         {
-            juce::ScopedValueSetter<bool> svs(context.isBypassed, dspPointers[i].bypassed); //reset bypass
+            ProcessUnit(units[i], stageBlock, frames);
+        }
 
-#if VERYFY_BYPASS_FUNCTIONALITY
-            if (context.isBypassed)
-            {
-                jassertfalse;
+        if (stage + 1 < pipelineDepth)
+            handoffs[stage].write(stageBlock);
+    };
+
+    if (useWorkers && numSamples >= minParallelSamples)
+    {
+        p.workers.run(pipelineDepth, runStage);
+    }
+    else
+    {
+        for (size_t stage = 0; stage < pipelineDepth; ++stage)
+            runStage(static_cast<int>(stage)); //same handoffs, so the latency does not change with the block size
+    }
+
+    block.copyFrom(getStageBlock(pipelineDepth - 1)); //written back after every stage read its input
 }
-            if (dspPointers[i].Processor == &generalFilter)
-            {
-                continue;
-            }
-#endif
 
-            dspPointers[i].Processor->process(context);
-            }
+int ProjectAudioAudioProcessor::ChainDSP::GetBranchLatencySamples(const Branch& branch) const
+{
+    int latency = 0;
+
+    for (size_t i = branch.firstSlot; i < branch.firstSlot + branch.numSlots; ++i)
+    {
+        latency += instances[slots[i].instance].GetStageLatencySamples(slots[i].option);
+    }
+
+    return latency;
+}
+
+void ProjectAudioAudioProcessor::ChainDSP::UpdateBranchDelays()
+{
+    int latency = 0;
+
+    for (size_t i = 0; i < numSplits; ++i)
+    {
+        const auto& split = splits[i];
+        std::array<int, maxSlots> branchLatencies{};
+        int longest = 0;
+
+        for (size_t b = 0; b < split.numBranches; ++b)
+        {
+            branchLatencies[b] = GetBranchLatencySamples(branches[split.firstBranch + b]);
+            longest = juce::jmax(longest, branchLatencies[b]);
+        }
+
+        for (size_t b = 0; b < split.numBranches; ++b)
+        {
+            branchDelays[split.firstBranch + b].setDelay(longest - branchLatencies[b]);
         }
 
+        latency += longest;
+    }
+
+    parallelLatency.store(latency, std::memory_order_relaxed);
+}
+
+void ProjectAudioAudioProcessor::ChainDSP::ProcessDynamic(juce::dsp::AudioBlock<float> block, const DSP_Order& dsporder)
+{
+    if (dsporder != chainOrder)
+    {
+        SetOrder(dsporder);
+    }
+
+    for (auto& instance : instances)
+    {
+        instance.UpdateBypassStates();
+    }
 
+    for (const auto& slot : slots)
+    {
+        if (slot.option == DSP_Option::END_OF_LIST)
+            break;
 
+        instances[slot.instance].ProcessSlotDynamic(slot.option, block);
+    }
 }
 
 
@@ -1085,19 +2079,21 @@ juce::AudioProcessorEditor* ProjectAudioAudioProcessor::createEditor()
 }
 
 //Fane:Used to convert var to DSP_Order and convert DSP_Order to var
+//one int per used slot: route * maxSlots + instance * numStages + option, so sessions saved before slots (5 bare options) load unchanged
 template<>      
 struct juce::VariantConverter <ProjectAudioAudioProcessor::DSP_Order>
 {
     static ProjectAudioAudioProcessor::DSP_Order fromVar(const juce::var& v) 
     {
         using T = ProjectAudioAudioProcessor::DSP_Order;
+        using Processor = ProjectAudioAudioProcessor;
         T dspOrder;
 
         jassert(v.isBinaryData());
 
         if (v.isBinaryData() == false)
         {
-            dspOrder.fill(ProjectAudioAudioProcessor::DSP_Option::END_OF_LIST);
+            dspOrder.fill({});
         }
         else
         {
@@ -1110,14 +2106,34 @@ struct juce::VariantConverter <ProjectAudioAudioProcessor::DSP_Order>
                 arr.push_back(mis.readInt());
             }
 
-            jassert(arr.size() == dspOrder.size());
-            
+            jassert(arr.size() <= dspOrder.size());
+
+            //unknown or repeated slots are dropped, the rest close up
+            size_t numSlots = 0;
 
-            for (size_t i = 0; i < dspOrder.size(); i++)
+            for (auto value : arr)
             {
-                dspOrder[i] = static_cast<ProjectAudioAudioProcessor::DSP_Option>(arr[i]);
+                if (value < 0 || numSlots == dspOrder.size())
+                    continue;
+
+                //stage, then route, then band; sessions from before bands decode to every band
+                constexpr auto numRoutes = static_cast<size_t>(Processor::DSP_Route::END_OF_LIST);
+                const auto stage = static_cast<size_t>(value) % Processor::maxSlots;
+                const auto routing = static_cast<size_t>(value) / Processor::maxSlots;
+
+                const Processor::DSP_Slot slot{ static_cast<Processor::DSP_Option>(stage % Processor::numStages),
+                                                stage / Processor::numStages,
+                                                static_cast<Processor::DSP_Route>(routing % numRoutes),
+                                                static_cast<Processor::DSP_Band>(routing / numRoutes) };
+
+                const auto end = dspOrder.begin() + static_cast<std::ptrdiff_t>(numSlots);
+                const auto repeated = std::find_if(dspOrder.begin(), end, [slot](const auto& s) { return s.RunsSameStage(slot); }) != end;
+
+                if (slot.band < Processor::DSP_Band::END_OF_LIST && !repeated)
+                {
+                    dspOrder[numSlots++] = slot;
+                }
             }
-            
         }
         return dspOrder;
     }
@@ -1131,7 +2147,14 @@ struct juce::VariantConverter <ProjectAudioAudioProcessor::DSP_Order>
 
             for (const auto& v : d)
             {
-                mos.writeInt(static_cast<int>(v));
+                if (v.option == ProjectAudioAudioProcessor::DSP_Option::END_OF_LIST)
+                    break; //the empty slots at the end are not saved
+
+                constexpr auto numRoutes = static_cast<size_t>(ProjectAudioAudioProcessor::DSP_Route::END_OF_LIST);
+                const auto routing = static_cast<size_t>(v.band) * numRoutes + static_cast<size_t>(v.route);
+
+                mos.writeInt(static_cast<int>(routing * ProjectAudioAudioProcessor::maxSlots
+                                              + v.instance * ProjectAudioAudioProcessor::numStages) + static_cast<int>(v.option));
             }
         }//also,now it is writing to mb correctly
 
@@ -1180,9 +2203,10 @@ void ProjectAudioAudioProcessor::setStateInformation (const void* data, int size
 #if VERYFY_BYPASS_FUNCTIONALITY //test Bypass
         juce::Timer::callAfterDelay(1000, [this]() {
             DSP_Order order;
-            order.fill(DSP_Option::LadderFilter);
-            order[0] = DSP_Option::Chorus;
-            ChorusBypass->setValueNotifyingHost(1.f);
+            order.fill({});
+            order[0] = { DSP_Option::Chorus, 0 };
+            order[1] = { DSP_Option::LadderFilter, 0 };
+            effectParameters[0].ChorusBypass->setValueNotifyingHost(1.f);
             dsporderFifo.push(order);
             });
 #endif
@@ -10,6 +10,24 @@
 
 #include <JuceHeader.h>
 #include <Fifo.h>
+#include "DSP/SIMDLaneProcessor.h"
+#include "DSP/SmootherBank.h"
+#include "DSP/ModulatedSVF.h"
+#include "DSP/FastMath.h"
+#include "DSP/BypassFader.h"
+#include "DSP/TailEstimate.h"
+#include "DSP/StageOversampler.h"
+#include "DSP/Waveshaper.h"
+#include "DSP/LanePhaser.h"
+#include "DSP/ZDFLadder.h"
+#include "DSP/SVFCascade.h"
+#include "DSP/LinearPhaseFilter.h"
+#include "DSP/ChainPermutations.h"
+#include "DSP/EnsembleChorus.h"
+#include "DSP/CompensationDelay.h"
+#include "DSP/WorkerPool.h"
+#include "DSP/AudioHandoff.h"
+#include "DSP/BandSplitter.h"
 
 //==============================================================================
 /**
@@ -18,6 +36,8 @@ class ProjectAudioAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                             , private juce::Timer
+                             , private juce::AudioProcessorParameter::Listener
 {
 public:
     //==============================================================================
@@ -67,126 +87,277 @@ public:
         END_OF_LIST
     };
 
-    std::vector<juce::RangedAudioParameter*> GetParamsForOption(ProjectAudioAudioProcessor::DSP_Option option);
+    //** a chain is a list of slots, each slot runs one instance of an effect with that instance's own parameters **//
+    static constexpr size_t numStages = static_cast<size_t>(DSP_Option::END_OF_LIST);
+    static constexpr size_t maxInstances = 2;                    //of every effect, all of them built before playback
+    static constexpr size_t maxSlots = numStages * maxInstances; //every instance at most once
+
+    //** routing: consecutive slots form splits, each split runs its branches side by side and mixes them **//
+    enum class DSP_Route
+    {
+        Series,   //after the slot before it, in the same branch
+        Branch,   //starts another branch of the split, fed the split's input
+        AfterMix, //starts a new split, fed the mix of the branches before it
+        END_OF_LIST
+    };
+
+    //** multiband: the slots run on one band of the crossover, or on every band with a state of their own in each **//
+    enum class DSP_Band
+    {
+        All,
+        Band1, //the lowest
+        Band2,
+        Band3,
+        Band4, //above the band count a slot runs on the highest band
+        END_OF_LIST
+    };
+
+    struct DSP_Slot
+    {
+        DSP_Option option = DSP_Option::END_OF_LIST; //END_OF_LIST: empty, the chain ended before this slot
+        size_t instance = 0;                         //index into effectParameters
+        DSP_Route route = DSP_Route::Series;         //ignored on the first slot
+        DSP_Band band = DSP_Band::All;               //ignored while multiband is off
+
+        bool operator==(const DSP_Slot&) const = default;
+
+        bool RunsSameStage(const DSP_Slot& other) const { return option == other.option && instance == other.instance; } //whatever the route
+    };
+
+    std::vector<juce::RangedAudioParameter*> GetParamsForOption(ProjectAudioAudioProcessor::DSP_Option option, size_t instance = 0);
 
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts{ *this,nullptr,"Settings",createParameterLayout() };//Create apvats
 
-    using DSP_Order = std::array<DSP_Option, static_cast<size_t>(DSP_Option::END_OF_LIST)>; //ͱһArray
+    using DSP_Order = std::array<DSP_Slot, maxSlots>; //ͱһArray ,slots in processing order, empty ones at the end
 
     SimpleMBComp::Fifo<DSP_Order> dsporderFifo; //Fifo
     SimpleMBComp::Fifo<DSP_Order> storedDspOrderFifo; //stored Fifo Order
+
+    //** cached parameters of one instance of every effect, filled from EffectRegistry **//
+    struct EffectParameters
+    {
+        /*
+          Phaser:
+          Rate: hz
+          Depth(percent): 0 to 1
+          Center Freq: hz
+          Feedback(percent): -1 to 1
+          Mix(percent): 0 to 1
+          Stages: 4,6,8,12
+          Stereo Offset: 0 to 180 degrees of LFO phase
+        */
+
+        //** added pointers for cached parameters above **//
+        juce::AudioParameterFloat* PhaserRateHz = nullptr;
+        juce::AudioParameterFloat* PhaserDepthPercent = nullptr;
+        juce::AudioParameterFloat* PhaserCenterFreqHz = nullptr;
+        juce::AudioParameterFloat* PhaserFeedbackPercet = nullptr;
+        juce::AudioParameterFloat* PhaserMixPercent = nullptr;
+        juce::AudioParameterChoice* PhaserStages = nullptr;
+        juce::AudioParameterFloat* PhaserStereoOffset = nullptr;
+        juce::AudioParameterBool*  PhaserBypass = nullptr;
+        //** added pointers for cached parameters above **//
+
+         /*
+          Chorus:
+          Rate: hz
+          Depth(percent): 0 to 1
+          Center Delay: 1 to 100ms
+          Feedback(percent): -1 to 1
+          Mix(percent): 0 to 1
+          Voices: 1 to 8
+          Stereo Spread(percent): 0 to 1
+        */
+
+        //** added pointers for cached parameters above **//
+        juce::AudioParameterFloat* ChorusRateHz = nullptr;
+        juce::AudioParameterFloat* ChorusDepthPercent = nullptr;
+        juce::AudioParameterFloat* ChorusCenterDelayMs = nullptr;
+        juce::AudioParameterFloat* ChorusFeedbackPercet = nullptr;
+        juce::AudioParameterFloat* ChorusMixPercent = nullptr;
+        juce::AudioParameterChoice* ChorusVoices = nullptr;
+        juce::AudioParameterFloat* ChorusStereoSpread = nullptr;
+        juce::AudioParameterBool*  ChorusBypass = nullptr;
+        //** added pointers for cached parameters above **//
+
+
+         /*
+          OverDrive:
+          drive:1-100
+          curve: tanh, soft clip, asymmetric tube
+          anti-aliasing: off, ADAA
+        */
+
+        //** added pointers for cached parameters above **//
+        juce::AudioParameterFloat* OverDriveSaturation = nullptr;
+        juce::AudioParameterChoice* OverDriveCurve = nullptr;
+        juce::AudioParameterChoice* OverDriveAntiAliasing = nullptr;
+        juce::AudioParameterChoice* OverDriveOversampling = nullptr;
+        juce::AudioParameterBool*  OverDriveBypass = nullptr;
+        //** added pointers for cached parameters above **//
+
+        /*
+        ladder filter:
+        mode: LadderFilterMode enum(int)
+        cutoff:hz
+        resonance: 0 to 1
+        drive: 1 - 100
+        */
+
+        //** added pointers for cached parameters above **//
+        juce::AudioParameterChoice* LadderFilterMode = nullptr;
+        juce::AudioParameterFloat* LadderFilterCutoffHz = nullptr;
+        juce::AudioParameterFloat* LadderFilterResonance = nullptr;
+        juce::AudioParameterFloat* LadderFilterDrive = nullptr;
+        juce::AudioParameterChoice* LadderFilterOversampling = nullptr;
+        juce::AudioParameterBool*  LadderFilterBypass = nullptr;
+        //** added pointers for cached parameters above **//
+
+        /*
+        oversampling of the nonlinear stages:
+        factor: 1x,2x,4x,8x per stage
+        filter: IIR (low latency) or FIR (linear phase), shared by both stages of an instance
+        */
+        juce::AudioParameterChoice* OversamplingFilter = nullptr;
+
+         /*
+        * general filter:SVF cascade
+        * Mode: Peak,bandpass,notch,allpass,low shelf,high shelf,lowpass,highpass
+        * slope: 12 - 96 dB/oct, 1 - 8 sections
+        * phase: minimum (IIR) or linear (FIR, adds latency)
+        * freq:20hz - 20,000hz in 1hz steps
+        * Q: 0.1 - 10 in 0.05 steps
+        * gain: -24db to +24db in 0.5db increments
+        */
+
+        //** added pointers for cached parameters above **//
+        juce::AudioParameterChoice* GeneralFilterMode = nullptr;
+        juce::AudioParameterChoice* GeneralFilterSlope = nullptr;
+        juce::AudioParameterChoice* GeneralFilterPhase = nullptr;
+        juce::AudioParameterFloat* GeneralFilterFreqHz = nullptr;
+        juce::AudioParameterFloat* GeneralFilterQuality = nullptr;
+        juce::AudioParameterFloat* GeneralFilterGain = nullptr;
+        juce::AudioParameterBool* GeneralFilterBypass = nullptr;
+         //** added pointers for cached parameters above **//
+    };
+
+    std::array<EffectParameters, maxInstances> effectParameters; //index = DSP_Slot::instance, instance 0 has the IDs from before slots
+
+    //** engine settings, once per processor **//
     /*
-      Phaser:
-      Rate: hz
-      Depth(percent): 0 to 1
-      Center Freq: hz
-      Feedback(percent): -1 to 1
-      Mix(percent): 0 to 1
+    control rate: samples between parameter updates, the stages ramp per sample in between
+    auto: about 1.3 ms, 64 samples at 48 kHz, per sample: every sample
     */
+    juce::AudioParameterChoice* ControlRate = nullptr;
 
-    //** added pointers for cached parameters above **//
-    juce::AudioParameterFloat* PhaserRateHz = nullptr;
-    juce::AudioParameterFloat* PhaserDepthPercent = nullptr;
-    juce::AudioParameterFloat* PhaserCenterFreqHz = nullptr;
-    juce::AudioParameterFloat* PhaserFeedbackPercet = nullptr;
-    juce::AudioParameterFloat* PhaserMixPercent = nullptr;
-    juce::AudioParameterBool*  PhaserBypass = nullptr;
-    //** added pointers for cached parameters above **//
-
-     /*
-      Chorus:
-      Rate: hz
-      Depth(percent): 0 to 1
-      Center Delay: 1 to 100ms
-      Feedback(percent): -1 to 1
-      Mix(percent): 0 to 1
+    /*
+    reorder crossfade: 0 - 1000 ms, a new order warms up on a second chain and fades in
+    0: the order switches at once, as before
     */
+    juce::AudioParameterFloat* ReorderCrossfadeMs = nullptr;
 
-    //** added pointers for cached parameters above **//
-    juce::AudioParameterFloat* ChorusRateHz = nullptr;
-    juce::AudioParameterFloat* ChorusDepthPercent = nullptr;
-    juce::AudioParameterFloat* ChorusCenterDelayMs = nullptr;
-    juce::AudioParameterFloat* ChorusFeedbackPercet = nullptr;
-    juce::AudioParameterFloat* ChorusMixPercent = nullptr;
-    juce::AudioParameterBool*  ChorusBypass = nullptr;
-    //** added pointers for cached parameters above **//
-
-
-     /*
-      OverDrive:
-      drive:1-100
+    /*
+    pipeline stages: off, 2 - 4, the chain cut into stages that run side by side on the worker pool
+    every stage after the first works one block behind the one before it, (stages - 1) blocks of latency
     */
+    juce::AudioParameterChoice* PipelineStages = nullptr;
 
-    //** added pointers for cached parameters above **//
-    juce::AudioParameterFloat* OverDriveSaturation = nullptr;
-    juce::AudioParameterBool*  OverDriveBypass = nullptr;
-    //** added pointers for cached parameters above **//
+    size_t GetPipelineDepth() const { return static_cast<size_t>(PipelineStages->getIndex()) + 1; } //1: off
 
     /*
-    ladder filter:
-    mode: LadderFilterMode enum(int)
-    cutoff:hz
-    resonance: 0 to 1
-    drive: 1 - 100
+    bands: off, 2 - 4, Linkwitz-Riley bands that each run the slots of their band and are summed back
+    crossovers: 20 - 20000 Hz, lowest first, only the first (bands - 1) are used
     */
+    juce::AudioParameterChoice* Bands = nullptr;
+    juce::AudioParameterFloat* CrossoverLowHz = nullptr;
+    juce::AudioParameterFloat* CrossoverMidHz = nullptr;
+    juce::AudioParameterFloat* CrossoverHighHz = nullptr;
 
-    //** added pointers for cached parameters above **//
-    juce::AudioParameterChoice* LadderFilterMode = nullptr;
-    juce::AudioParameterFloat* LadderFilterCutoffHz = nullptr;
-    juce::AudioParameterFloat* LadderFilterResonance = nullptr;
-    juce::AudioParameterFloat* LadderFilterDrive = nullptr;
-    juce::AudioParameterBool*  LadderFilterBypass = nullptr;
-    //** added pointers for cached parameters above **//
-
-     /*
-    * general filter:IIRFilter
-    * Mode: Peak,bandpass,notch,allpass,
-    * freq:20hz - 20,000hz in 1hz steps
-    * Q: 0.1 - 10 in 0.05 steps
-    * gain: -24db to +24db in 0.5db increments
-    */
+    size_t GetNumBands() const { return static_cast<size_t>(Bands->getIndex()) + 1; } //1: off
+
+    ProjectAudio::BandSplitter::Crossovers GetCrossovers() const { return { CrossoverLowHz->get(), CrossoverMidHz->get(), CrossoverHighHz->get() }; }
+
+    //** one smoother for every float parameter of every instance, index = instance * numSmoothedParams + SmoothedParam **//
+    enum class SmoothedParam
+    {
+        PhaserRateHz,
+        PhaserCenterFreqHz,
+        PhaserDepthPercent,
+        PhaserFeedbackPercent,
+        PhaserMixPercent,
+        PhaserStereoOffset,
+        ChorusRateHz,
+        ChorusDepthPercent,
+        ChorusCenterDelayMs,
+        ChorusFeedbackPercent,
+        ChorusMixPercent,
+        ChorusStereoSpread,
+        OverdriveSaturation,
+        LadderFilterCutoffHz,
+        LadderFilterResonance,
+        LadderFilterDrive,
+        GeneralFilterFreqHz,
+        GeneralFilterQuality,
+        GeneralFilterGain,
+        END_OF_LIST
+    };
+
+    static constexpr size_t numSmoothedParams = static_cast<size_t>(SmoothedParam::END_OF_LIST); //of one instance
+    static constexpr size_t numSmoothers = numSmoothedParams * maxInstances;
+
+    float getSmoothedValue(SmoothedParam param, size_t instance = 0) const
+    {
+        return smoothers.getCurrentValue(instance * numSmoothedParams + static_cast<size_t>(param));
+    }
+
+    //** one control interval as the stages see it, captured before the chains run so any thread can apply it later **//
+    struct ControlFrame {
+        std::array<float, numSmoothers> values{};           //index = instance * numSmoothedParams + SmoothedParam
+        std::array<juce::uint64, maxSlots> stageVersions{}; //index = instance * numStages + DSP_Option
+        int numSamples = 0;
+    };
+
+    using ControlFrames = std::span<const ControlFrame>; //the sub-blocks of one chunk, in order, their sizes add up to it
+    static constexpr size_t maxControlFrames = 128;       //a host block with more intervals runs as several chunks
+
+    //function(subBlock, frame) for every frame of 'block', in order
+    template <typename Function>
+    static void ForEachControlFrame(juce::dsp::AudioBlock<float> block, ControlFrames frames, Function&& function)
+    {
+        size_t start = 0;
+
+        for (const auto& frame : frames)
+        {
+            const auto numSamples = static_cast<size_t>(frame.numSamples);
+            function(block.getSubBlock(start, numSamples), frame);
+            start += numSamples;
+        }
+
+        jassert(start == block.getNumSamples());
+    }
+
+    static constexpr std::array<size_t, 4> phaserStageCounts{ 4, 6, 8, 12 }; //same order as the Phaser Stages choices
+    static constexpr std::array<int, 7> controlIntervals{ 0, 1, 8, 16, 32, 64, 128 }; //same order as the Control Rate choices, 0 = auto
+    static constexpr double autoControlPeriodSeconds = 0.00133;
 
-    //** added pointers for cached parameters above **//
-    juce::AudioParameterChoice* GeneralFilterMode = nullptr;
-    juce::AudioParameterFloat* GeneralFilterFreqHz = nullptr;
-    juce::AudioParameterFloat* GeneralFilterQuality = nullptr;
-    juce::AudioParameterFloat* GeneralFilterGain = nullptr;
-    juce::AudioParameterBool* GeneralFilterBypass = nullptr;
-     //** added pointers for cached parameters above **//
-
-
-    //** added smoother for every parameters  **//
-    juce::SmoothedValue<float>
-        phaserRateHzSmoother,
-        phaserCenterFreqHzSmoother,
-        phaserDepthPercentSmoother,
-        phaserFeedbackPercentSmoother,
-        phaserMixPercentSmoother,
-        chorusRateHzSmoother,
-        chorusDepthPercentSmoother,
-        chorusCenterDelayMsSmoother,
-        chorusFeedbackPercentSmoother,
-        chorusMixPercentSmoother,
-        overdriveSaturationSmoother,
-        ladderFilterCutoffHzSmoother,
-        ladderFilterResonanceSmoother,
-        ladderFilterDriveSmoother,
-        generalFilterFreqHzSmoother,
-        generalFilterQualitySmoother,
-        generalFilterGainSmoother;
-    //** added smoother for every parameters  **//
+    int GetControlInterval() const; //samples per sub-block of processBlock
+    //** one smoother for every float parameter of every instance, index = instance * numSmoothedParams + SmoothedParam **//
    
     
 
 
     //** add enum for generalFilterMode **//
-    enum class generalFilterMode { //use the IIR filter,so need to aware of Coefficients
+    enum class generalFilterMode { //same order as ProjectAudio::SVFResponse
 
         Peak,
         Bandpass,
         Notch,
         Allpass,
+        LowShelf,
+        HighShelf,
+        Lowpass,
+        Highpass,
         END_OF_LIST
 
     };
@@ -198,6 +369,11 @@ private:
     template<typename DSP>
     struct DSP_Choice : juce::dsp::ProcessorBase  //ģ̳ProcessorBase
     {
+        DSP_Choice() = default;
+
+        template <typename... Args>
+        explicit DSP_Choice(std::in_place_t, Args&&... args) : dsp(std::forward<Args>(args)...) {} //a DSP that takes constructor arguments
+
         void prepare(const juce::dsp::ProcessSpec& spec) override
         {
             dsp.prepare(spec);
@@ -216,56 +392,336 @@ private:
         DSP dsp;
     };
     
-    /*Wrap dspChoice into MonoChannel*/
-    struct MonoChannelDSP {                                                        
-        MonoChannelDSP(ProjectAudioAudioProcessor& proc) : p(proc) {}; //init ProjectAudioAudioProcessor
+    struct ProcessState {
+        juce::dsp::ProcessorBase* Processor;
+        bool bypassed = false;
+    };
+
+    /*Wrap dspChoice into one engine that processes all channels together*/
+    struct MultiChannelDSP {                                                        
+        MultiChannelDSP(ProjectAudioAudioProcessor& proc, size_t instanceIndex) //init ProjectAudioAudioProcessor
+            : linearPhaseFilter(std::in_place, proc.convolutionQueue), params(proc.effectParameters[instanceIndex]), instance(instanceIndex) {};
 
         DSP_Choice<juce::dsp::DelayLine<float>> delaytime;
-        DSP_Choice<juce::dsp::Phaser<float>> phaser;
-        DSP_Choice<juce::dsp::Chorus<float>> chorus;
-        DSP_Choice<juce::dsp::LadderFilter<float>> overdrive, ladderFilter;
-        DSP_Choice<juce::dsp::IIR::Filter<float>> generalFilter;
+        DSP_Choice<ProjectAudio::SIMDLaneProcessor<ProjectAudio::LanePhaser<ProjectAudio::LaneRegister>>> phaser; //channels in SIMD lanes
+        DSP_Choice<ProjectAudio::EnsembleChorus> chorus; //voices in SIMD lanes
+        DSP_Choice<ProjectAudio::Waveshaper> overdrive;
+        DSP_Choice<ProjectAudio::SIMDLaneProcessor<ProjectAudio::ZDFLadder<ProjectAudio::LaneRegister>>> ladderFilter; //channels in SIMD lanes
+        DSP_Choice<ProjectAudio::SIMDLaneProcessor<ProjectAudio::SVFCascade<ProjectAudio::LaneRegister>>> generalFilter; //channels in SIMD lanes
+        DSP_Choice<ProjectAudio::LinearPhaseFilter> linearPhaseFilter; //runs in place of generalFilter in linear phase
+
+        void Prepare(const juce::dsp::ProcessSpec& spec); //spec.numChannels = every channel of the bus
+
+        void Restart(); //audio thread: clean state and every setter on the next update, nothing allocated
+
+        static constexpr juce::uint32 allStages = (1u << numStages) - 1;
+
+        //setters only run for awake stages whose parameters moved, 'stages' (bit = DSP_Option) limits it to some
+        //different stages may update on different threads at once, they share nothing
+        void UpdateDSPfromParams(const ControlFrame& frame, juce::uint32 stages = allStages);
+
+        //audio thread, once per chunk before any stage runs: the phase mode switch and the oversampling factors,
+        //so the latencies hold still for the whole chunk, and the bypass state of stages no slot runs
+        void UpdateEngines();
+
+        void ForceFullUpdate() { appliedVersions = MakeInvalidVersions(); } //the next update runs every setter of every awake stage
+
+        //** stages the chain's order does not use are bypassed: asleep, no tail, no latency **//
+        void SetUsedStages(juce::uint32 stages); //bit = DSP_Option, audio thread
+
+        void UpdateBypassStates(juce::uint32 stages = allStages); //bypassed stages are neither updated nor processed, toggles crossfade
+
+        //every stage of this instance in one inlined chain, 'rank' of the order in ChainPermutations
+        void ProcessPermutation(juce::dsp::AudioBlock<float> block, size_t rank) { (this->*chainTable[rank])(block); }
+
+        void ProcessSlot(DSP_Option option, juce::dsp::AudioBlock<float> block); //one stage, no virtual call
+
+        //virtual dispatch through ProcessorBase, the benchmark reference
+        void ProcessSlotDynamic(DSP_Option option, juce::dsp::AudioBlock<float> block);
+
+        double GetTailLengthSeconds() const; //sum of the tails of every stage that is not bypassed
+
+        int GetLatencySamples() const; //sum of the oversampling and FIR latencies of every stage a slot runs
+
+        int GetStageLatencySamples(DSP_Option option) const; //0 when no slot runs it, a bypassed stage keeps its own, any thread
+
+        int GetMaxLatencySamples() const; //every stage at its longest setting, after Prepare
 
-        void Prepare(const juce::dsp::ProcessSpec& spec);
+        int GetMaxStageLatencySamples(DSP_Option option) const; //one stage at its longest setting, after Prepare
+
+        void LoadLinearPhaseFir(const juce::AudioBuffer<float>& fir) { linearPhaseFilter.dsp.loadFir(fir); } //message thread, from UpdateLinearPhaseDesigns
+
+        static constexpr size_t numPermutations = ProjectAudio::ChainPermutations::factorial(numStages);
 
-        void UpdateDSPfromParams();
-        
-        void Process(juce::dsp::AudioBlock<float> block, const DSP_Order& dsporder);
     private:
-        ProjectAudioAudioProcessor& p;
+        const EffectParameters& params; //this instance's parameters
+        const size_t instance;
+
+        float GetSmoothedValue(const ControlFrame& frame, SmoothedParam param) const { return frame.values[instance * numSmoothedParams + static_cast<size_t>(param)]; }
+
+        ProcessState GetProcessState(DSP_Option option);
+
+        bool IsStageBypassed(DSP_Option option) const; //bypass parameter, settings that make it an identity, or not in the order
+        bool IsIdentity(DSP_Option option) const;
+        bool IsStageUsed(DSP_Option option) const { return ((usedStages.load(std::memory_order_relaxed) >> static_cast<juce::uint32>(option)) & 1u) != 0; }
+
+        bool IsLinearPhase() const { return params.GeneralFilterPhase->getIndex() == 1; }
+
+        bool IsStageAsleep(DSP_Option option) const { return bypassFaders[static_cast<size_t>(option)].isFullyBypassed(); }
+
+        std::atomic<juce::uint32> usedStages{ 0 }; //written by the audio thread, tail and latency read it anywhere
+
+        //** dirty tracking: the stage version last pushed into each stage's setters **//
+        bool ConsumeStageChange(DSP_Option option, const ControlFrame& frame); //false when asleep or nothing moved since the last call
+        void InvalidateStage(DSP_Option option) { appliedVersions[static_cast<size_t>(option)] = invalidVersion; }
+
+        using StageVersions = std::array<juce::uint64, numStages>; //index = DSP_Option
+        static constexpr juce::uint64 invalidVersion = std::numeric_limits<juce::uint64>::max();
+
+        static StageVersions MakeInvalidVersions() { StageVersions versions; versions.fill(invalidVersion); return versions; }
+
+        StageVersions appliedVersions = MakeInvalidVersions();
+
+        std::array<ProjectAudio::BypassFader, numStages> bypassFaders; //index = DSP_Option
+
+        //** one inlined chain per stage order, the chain picks one by rank **//
+        using ChainFunction = void (MultiChannelDSP::*)(juce::dsp::AudioBlock<float>);
+
+        template <size_t... Order>
+        void ProcessChain(juce::dsp::AudioBlock<float> block) { (ProcessStage<static_cast<DSP_Option>(Order)>(block), ...); }
+
+        template <DSP_Option Option>
+        void ProcessStage(juce::dsp::AudioBlock<float> block);
+
+        static const std::array<ChainFunction, numPermutations> chainTable; //index = permutation rank
+
+        //** only the nonlinear stages run oversampled, inside their bypass fader **//
+        void UpdateOversampling();
+        ProjectAudio::StageOversampler* GetOversampler(DSP_Option option);
+
+        ProjectAudio::StageOversampler overdriveOversampler, ladderOversampler;
+
+        float invSampleRate = 0.f; //for ProjectAudio::FastMath::tanPi
+
 
         //**default GeneralFilter Params **//
         generalFilterMode gfMode = generalFilterMode::END_OF_LIST;
         float filterFreq = 0.f;
         float filterQ = 0.f;
         float filterGain = -100.f;
+        size_t filterSections = 0;
+        std::atomic<bool> linearPhaseSelected{ false }; //which general filter engine Process runs, the latency reads it anywhere
         //**default GeneralFilter Params,they are outside the range **//
     };
 
-    MonoChannelDSP leftChannel{ *this };  //set 2 instances
-    MonoChannelDSP rightChannel{ *this };
-    /*Wrap dspChoice into MonoChannel*/
+    /*Wrap dspChoice into one engine that processes all channels together*/
 
-    struct ProcessState {
-        juce::dsp::ProcessorBase* Processor;
-        bool bypassed = false;
+    /*One chain: an engine for every instance, all prepared in prepareToPlay, and the order of slots run through them*/
+    struct ChainDSP {
+        ChainDSP(ProjectAudioAudioProcessor& proc) : instances(MakeInstances(proc, std::make_index_sequence<maxInstances>{})), p(proc) {};
+
+        std::array<MultiChannelDSP, maxInstances> instances; //index = DSP_Slot::instance, adding a slot only wakes one up
+
+        void Prepare(const juce::dsp::ProcessSpec& spec, const DSP_Order& dsporder);
+
+        void Restart(const DSP_Order& dsporder); //audio thread: clean state in the new order, nothing allocated
+
+        void Idle() { SetOrder(DSP_Order()); } //no slots, nothing counts for the tail or the latency
+
+        void UpdateDSPfromParams(const ControlFrame& frame); //every instance at once, Process updates slot by slot itself
+
+        void ForceFullUpdate();
+
+        //the whole chunk, each slot updated from each frame before it runs that frame's sub-block
+        //useWorkers: false on a worker thread, only the audio thread may hand out work
+        void Process(juce::dsp::AudioBlock<float> block, const DSP_Order& dsporder, ControlFrames frames, bool useWorkers = true);
+
+        //virtual dispatch through ProcessorBase, slot by slot in series whatever the routing, as the benchmark reference
+        void ProcessDynamic(juce::dsp::AudioBlock<float> block, const DSP_Order& dsporder);
+
+        double GetTailLengthSeconds() const; //stages in series, the tails of every instance add up, an upper bound for splits
+
+        int GetLatencySamples() const; //splits count their longest branch
+
+        void LoadLinearPhaseFir(size_t instance, const juce::AudioBuffer<float>& fir) { instances[instance].LoadLinearPhaseFir(fir); }
+
+        //below this many samples a chunk runs its branches one after another, the handoff would cost more than it saves
+        static constexpr size_t minParallelSamples = 64;
+
+        //** pipeline: the chain cut into stages, stage k runs on the block stage k - 1 finished one call earlier **//
+        static constexpr size_t maxPipelineDepth = 4;
+
+        void SetPipelineDepth(size_t depth); //audio thread, 1 = off, a new depth starts from silence in the handoffs
+
+        //tasks one block can hand the worker pool: the pipeline's stages, or the branches of the widest split, any thread
+        int GetParallelTasks() const { return parallelTasks.load(std::memory_order_relaxed); }
+
+    private:
+        template <size_t... Instance>
+        static std::array<MultiChannelDSP, maxInstances> MakeInstances(ProjectAudioAudioProcessor& proc, std::index_sequence<Instance...>)
+        {
+            return { MultiChannelDSP{ proc, Instance }... };
+        }
+
+        void SetOrder(const DSP_Order& dsporder); //wakes the stages in the order, the rest sleep
+
+        ProjectAudioAudioProcessor& p;
+
+        DSP_Order chainOrder;  //as requested, compared every block
+        DSP_Order slots;       //chainOrder without invalid or repeated slots
+        size_t permutation = MultiChannelDSP::numPermutations; //rank when the order is every stage of instance 0 once, the inlined chain
+
+        //** the slots as a graph: splits in series, each split's branches in parallel, each branch's slots in series **//
+        struct Branch { size_t firstSlot = 0, numSlots = 0; };
+        struct Split { size_t firstBranch = 0, numBranches = 0; };
+
+        std::array<Branch, maxSlots> branches; //every slot in exactly one branch
+        std::array<Split, maxSlots> splits;
+        size_t numBranches = 0, numSplits = 0;
+        bool parallel = false; //a split with more than one branch, otherwise the slots run in series as before
+
+        void UpdateSlot(const DSP_Slot& slot, const ControlFrame& frame) { instances[slot.instance].UpdateDSPfromParams(frame, 1u << static_cast<juce::uint32>(slot.option)); }
+
+        void ProcessBranch(const Branch& branch, juce::dsp::AudioBlock<float> block, ControlFrames frames); //every frame, on one thread
+        void ProcessSplit(const Split& split, juce::dsp::AudioBlock<float> block, ControlFrames frames, bool useWorkers = true); //branches on the worker pool, then the mix
+        int GetBranchLatencySamples(const Branch& branch) const;
+        void UpdateBranchDelays(); //lines up the branches of every split, audio thread
+
+        juce::AudioBuffer<float> branchBuffer;                              //maxSlots blocks of every channel, sized in Prepare
+        std::array<ProjectAudio::CompensationDelay, maxSlots> branchDelays; //index = branch
+        std::atomic<int> parallelLatency{ -1 }; //longest path through the splits, kept by the audio thread, -1: no splits
+
+        //** pipeline units: a slot of a single-branch split, or a whole split, the stages cut between units **//
+        struct PipelineUnit { size_t index = 0; bool isSplit = false; };
+
+        std::array<PipelineUnit, maxSlots> units;
+        size_t numUnits = 0;
+
+        void ProcessUnit(const PipelineUnit& unit, juce::dsp::AudioBlock<float> block, ControlFrames frames);
+        void ProcessPipelined(juce::dsp::AudioBlock<float> block, ControlFrames frames, bool useWorkers); //every stage on the worker pool, handoffs in between
+
+        size_t pipelineDepth = 1;
+        int pipelineDelay = 0;     //samples each handoff holds, the prepared block size: the longest chunk
+        double sampleRate = 44100.0;
+        std::array<ProjectAudio::AudioHandoff, maxPipelineDepth - 1> handoffs; //index = the stage that writes it
+        juce::AudioBuffer<float> pipelineBuffer;                               //one block per stage, sized in Prepare
+        std::atomic<int> pipelineLatency{ 0 };
+
+        void UpdateParallelTasks(); //after the order or the depth moved
+        std::atomic<int> parallelTasks{ 1 };
     };
-    using DSP_Pointers = std::array<ProcessState, static_cast<size_t>(DSP_Option::END_OF_LIST)>;//ñָ
+
+    /*A chain per band: the crossover splits the block, every band runs its slots, the bands add up again*/
+    struct MultibandDSP {
+        MultibandDSP(ProjectAudioAudioProcessor& proc) : bands(MakeBands(proc, std::make_index_sequence<maxBands>{})), p(proc) {};
+
+        static constexpr size_t maxBands = ProjectAudio::BandSplitter::maxBands;
+
+        std::array<ChainDSP, maxBands> bands; //lowest first, band 0 runs the whole order while multiband is off
+
+        void Prepare(const juce::dsp::ProcessSpec& spec, const DSP_Order& dsporder);
+
+        void Restart(const DSP_Order& dsporder); //audio thread: clean state in the new order, nothing allocated
+
+        void Idle();
+
+        void UpdateDSPfromParams(const ControlFrame& frame); //bands in use only, the others are idle
+
+        void ForceFullUpdate();
+
+        void Process(juce::dsp::AudioBlock<float> block, const DSP_Order& dsporder, ControlFrames frames);
+
+        //band 0 slot by slot, as the benchmark reference
+        void ProcessDynamic(juce::dsp::AudioBlock<float> block, const DSP_Order& dsporder) { bands[0].ProcessDynamic(block, dsporder); }
+
+        double GetTailLengthSeconds() const; //the longest band, idle bands have no slots
+
+        int GetLatencySamples() const; //the longest band, the others are delayed to it
+
+        void LoadLinearPhaseFir(size_t instance, const juce::AudioBuffer<float>& fir); //every band, idle ones too
+
+        void SetPipelineDepth(size_t depth); //every band, so they stay in time
+
+        //** audio thread, every block: a new band count restarts the bands, crossovers follow the parameters **//
+        void SetNumBands(size_t newNumBands);
+        void SetCrossovers(const ProjectAudio::BandSplitter::Crossovers& hz) { splitter.setCrossovers(hz); }
+
+        int GetParallelTasks() const; //the bands, or what band 0 hands out while multiband is off, any thread
+
+    private:
+        template <size_t... Band>
+        static std::array<ChainDSP, maxBands> MakeBands(ProjectAudioAudioProcessor& proc, std::index_sequence<Band...>)
+        {
+            return { (static_cast<void>(Band), ChainDSP{ proc })... };
+        }
+
+        void SetOrder(const DSP_Order& dsporder); //each band's slots, routes closed up over the slots it skips
+
+        void ProcessBands(juce::dsp::AudioBlock<float> block, ControlFrames frames); //split, every band, sum
+
+        ProjectAudioAudioProcessor& p;
+
+        DSP_Order chainOrder; //as requested, compared every block
+        std::array<DSP_Order, maxBands> bandOrders;
+        size_t numBands = 1;
+        std::atomic<int> numBandsInUse{ 1 }; //numBands for the message thread
+
+        ProjectAudio::BandSplitter splitter;
+        juce::AudioBuffer<float> bandBuffer;                              //maxBands blocks of every channel, sized in Prepare
+        std::array<ProjectAudio::CompensationDelay, maxBands> bandDelays; //each band in time with the slowest
+    };
+
+    ProjectAudio::WorkerClient workers; //this instance's lane in the shared pool, sized to the routing in prepareToPlay and the timer
+    int workerBlockSize = 0;            //what the realtime workers are told a block takes
+    double workerSampleRate = 44100.0;
+
+    void UpdateWorkerDemand(); //message thread
+
+    //one background thread builds the convolution engines of every linear-phase filter, declared before the chains so it outlives them
+    juce::dsp::ConvolutionMessageQueue convolutionQueue;
+
+    MultibandDSP channelDSP{ *this };  //one engine per instance and band for all channels, control-rate work happens once
+    MultibandDSP shadowDSP{ *this };   //same engines again, a new order warms up here before it is heard
+
+    //** reorder: the standby chain restarts in the new order, runs silently for the tail, then crossfades in **//
+    MultibandDSP* activeChain = &channelDSP;
+    MultibandDSP* standbyChain = &shadowDSP;
+
+    DSP_Order playingOrder;  //order of activeChain, dsporder is the latest request
+    DSP_Order reorderOrder;  //order of standbyChain while switching
+    juce::AudioBuffer<float> reorderBuffer; //standby output, one chunk, sized in prepareToPlay
+
+    bool reordering = false;
+    int reorderPosition = 0; //samples since the switch began
+    int reorderWarmup = 0, reorderFade = 0;
+    static constexpr double maxReorderWarmupSeconds = 0.1;
+
+    void BeginReorder();
+    void FinishReorder(); //standby becomes active
+    void ProcessReorder(juce::dsp::AudioBlock<float> block, ControlFrames frames); //both chains, then the fade, until the switch ends
 
 #define VERYFY_BYPASS_FUNCTIONALITY false // Fane:Macro to test Bypass
     
-    template <typename ParamType,typename Params,typename Funcs>
-    void initCachedPtrParam(Params paramArray,Funcs funcArray )   //Fane:Template Used to init cachedPtrParams
-    {
-        for (size_t i = 0; i < paramArray.size(); ++i)
-        {
-            auto ptrToParamsPtr = paramArray[i];
-            *ptrToParamsPtr = dynamic_cast<ParamType>(apvts.getParameter(funcArray[i]()));
-            jassert(*ptrToParamsPtr != nullptr);
-        };
-    }
+    ProjectAudio::SmootherBank<numSmoothers> smoothers;                    //all smoothers advance in one pass
+    std::array<juce::AudioParameterFloat*, numSmoothers> smoothedParams{}; //source of each smoother's target, filled from EffectRegistry
+
+    //** stage versions: smoother versions plus a counter bumped by listeners on the parameters that are not smoothed **//
+    //** one per stage of every instance, index and bit = instance * numStages + DSP_Option **//
+    std::array<std::bitset<numSmoothers>, maxSlots> stageSmoothers{};
+    std::array<std::atomic<juce::uint32>, maxSlots> stageEvents{};
+    std::vector<juce::uint32> parameterStages; //index = parameter index, built in the constructor
+    static_assert(maxSlots <= 32, "parameterStages holds one bit per stage of every instance");
+
+    juce::uint64 GetStageVersion(DSP_Option option, size_t instance) const; //moves whenever a parameter of the stage does
+
+    void parameterValueChanged(int parameterIndex, float newValue) override; //any thread, lock-free
+    void parameterGestureChanged(int, bool) override {}
 
-    std::vector<juce::SmoothedValue<float>*> getSmoothers();
+    //** sleep: silent input for longer than the tail and a silent output skip the whole chain **//
+    static constexpr float silenceThreshold = 1.0e-6f; //-120 dB
+    juce::int64 silentInputSamples = 0;
+    int autoControlInterval = 64; //follows the sample rate, set in prepareToPlay
+    bool asleep = false;
 
     enum class SmootherUpdateMode{
         initialize,
@@ -273,6 +729,30 @@ private:
     };
 
     void UpdateSmoothersByParams(int numSampleToSkip, SmootherUpdateMode init);
+
+    //** chunks: up to maxControlFrames control intervals captured up front, then every chain runs them all at once **//
+    std::array<ControlFrame, maxControlFrames> controlFrames;
+    int maxChunkSamples = 1; //the prepared block size, every scratch buffer holds one chunk
+
+    void CaptureControlFrame(ControlFrame& frame, int numSamples) const; //the smoothers as they are now
+
+    void timerCallback() override; //reports the latency to the host, rebuilds the linear-phase FIR and sizes the workers, message thread
+
+    //** linear phase: one FIR per instance, designed once and loaded into that instance of every band of both chains **//
+    struct LinearPhaseParams
+    {
+        int mode = -1, sections = 0;
+        float freq = 0.f, q = 0.f, gain = 0.f;
+        double sampleRate = 0.0;
+
+        bool operator==(const LinearPhaseParams&) const = default;
+    };
+
+    std::array<LinearPhaseParams, maxInstances> linearPhaseParams; //of the current FIRs, message thread only
+
+    void UpdateLinearPhaseDesigns(); //message thread, a new FIR for every instance whose general filter moved
+
+    friend struct BenchmarkAccess; //Tools/Benchmarks times the private stages directly
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProjectAudioAudioProcessor)
 };
@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+    BenchmarkAccess.h
+    The processor befriends this struct so the benchmarks can drive its private
+    stages one at a time, without a host in between.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PluginProcessor.h"
+
+struct BenchmarkAccess
+{
+    using Processor = ProjectAudioAudioProcessor;
+
+    /** A processor prepared like a host would, with 'state' applied and its dsp order pulled in. */
+    static std::unique_ptr<Processor> createPreparedProcessor(const juce::MemoryBlock& state,
+                                                              double sampleRate, int blockSize)
+    {
+        auto processor = std::make_unique<Processor>();
+
+        if (!state.isEmpty())
+            processor->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+        processor->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+        processor->prepareToPlay(sampleRate, blockSize);
+
+        //run one block so a pending dsp order from the state gets pulled in
+        juce::AudioBuffer<float> buffer(2, blockSize);
+        juce::MidiBuffer midi;
+        buffer.clear();
+        processor->processBlock(buffer, midi);
+
+        return processor;
+    }
+
+    struct Stage
+    {
+        juce::String name;
+        juce::dsp::ProcessorBase* processor = nullptr;
+    };
+
+    /** Every DSP_Choice stage of the channel engine's first instance, in DSP_Option order. */
+    static std::vector<Stage> getStages(Processor& p)
+    {
+        auto& channel = p.channelDSP.bands[0].instances[0];
+
+        return {
+            { "phaser", &channel.phaser },
+            { "chorus", &channel.chorus },
+            { "overdrive", &channel.overdrive },
+            { "ladderFilter", &channel.ladderFilter },
+            { "generalFilter", &channel.generalFilter },
+            { "generalFilter (linear phase)", &channel.linearPhaseFilter },
+        };
+    }
+
+    /** One control frame of the smoothers as they are now, numSamples long, for driving the chains directly. */
+    static Processor::ControlFrames captureFrame(Processor& p, int numSamples)
+    {
+        p.CaptureControlFrame(p.controlFrames[0], numSamples);
+        return { p.controlFrames.data(), 1 };
+    }
+
+    /** Pushes the current smoother values into the engine's stages. */
+    static void updateDSPfromParams(Processor& p)
+    {
+        p.channelDSP.UpdateDSPfromParams(captureFrame(p, 0)[0]);
+    }
+
+    /** Drops the dirty tracking once, the next update pushes every setter like before it existed. */
+    static void forceFullUpdate(Processor& p)
+    {
+        p.channelDSP.ForceFullUpdate();
+    }
+
+    /** One control tick: read the parameters, advance every smoother numSamples. */
+    static void updateSmoothers(Processor& p, int numSamples)
+    {
+        p.UpdateSmoothersByParams(numSamples, Processor::SmootherUpdateMode::liveInRealtime);
+    }
+
+    /** Index into the Control Rate choices, 0 = auto. */
+    static void setControlRate(Processor& p, int choiceIndex)
+    {
+        *p.ControlRate = choiceIndex;
+    }
+
+    static std::vector<juce::AudioParameterFloat*> getSmoothedParams(Processor& p)
+    {
+        return { p.smoothedParams.begin(), p.smoothedParams.end() };
+    }
+
+    static void processChain(Processor& p, juce::dsp::AudioBlock<float> block)
+    {
+        processChain(p, block, p.dsporder);
+    }
+
+    /** Any list of slots, the chain switches to it on the first call. The whole block is one control interval. */
+    static void processChain(Processor& p, juce::dsp::AudioBlock<float> block, const Processor::DSP_Order& order)
+    {
+        p.channelDSP.Process(block, order, captureFrame(p, static_cast<int>(block.getNumSamples())));
+    }
+
+    /** Worker threads for the branches of a split, 0 runs every branch on the calling thread. */
+    static void setWorkerThreads(Processor& p, int numWorkers, int blockSize, double sampleRate)
+    {
+        p.workers.setDemand(numWorkers, blockSize, sampleRate); //the shared pool may give fewer, see getWorkerThreads
+    }
+
+    static int getWorkerThreads(const Processor& p) { return p.workers.getNumWorkers(); }
+
+    /** Workers the shared pool can run at most, the cores besides the audio thread. */
+    static int getSpareCores() { return juce::jmin(ProjectAudio::WorkerPool::maxWorkers, juce::SystemStats::getNumCpus() - 1); }
+
+    static constexpr size_t maxPipelineDepth = Processor::ChainDSP::maxPipelineDepth;
+    static constexpr size_t maxBands = Processor::MultibandDSP::maxBands;
+
+    /** Stages the channel chain is cut into, 1 runs it unpipelined. Sets the parameter too, processBlock follows it. */
+    static void setPipelineDepth(Processor& p, size_t depth)
+    {
+        *p.PipelineStages = static_cast<int>(depth) - 1;
+        p.channelDSP.SetPipelineDepth(depth);
+    }
+
+    /** Crossover bands of the channel chain, 1 runs it on the whole signal. Sets the parameter too, processBlock follows it. */
+    static void setNumBands(Processor& p, size_t numBands)
+    {
+        *p.Bands = static_cast<int>(numBands) - 1;
+        p.channelDSP.SetCrossovers(p.GetCrossovers());
+        p.channelDSP.SetNumBands(numBands);
+    }
+
+    /** Gives instance 'to' of every effect the parameter values of instance 'from'. */
+    static void copyInstance(Processor& p, size_t from, size_t to)
+    {
+        for (size_t i = 0; i < Processor::numStages; ++i)
+        {
+            const auto option = static_cast<Processor::DSP_Option>(i);
+            const auto source = p.GetParamsForOption(option, from);
+            const auto target = p.GetParamsForOption(option, to);
+
+            for (size_t k = 0; k < source.size(); ++k)
+                target[k]->setValueNotifyingHost(source[k]->getValue());
+        }
+    }
+
+    /** The same chain through DSP_Pointers and virtual ProcessorBase calls. */
+    static void processChainDynamic(Processor& p, juce::dsp::AudioBlock<float> block)
+    {
+        p.channelDSP.ProcessDynamic(block, p.dsporder);
+    }
+
+    /** Queues the order the way the editor does, processBlock picks it up. */
+    static void requestOrder(Processor& p, const Processor::DSP_Order& order)
+    {
+        p.dsporderFifo.push(order);
+    }
+
+    static Processor::DSP_Order getRequestedOrder(Processor& p) { return p.dsporder; }
+
+    /** Requests and plays 'order' at once, no crossfade: processBlock runs it from its next call. */
+    static void setOrder(Processor& p, const Processor::DSP_Order& order)
+    {
+        p.dsporder = order;
+        p.playingOrder = order;
+    }
+
+    static bool isReordering(const Processor& p) { return p.reordering; }
+
+    static void setAllBypassed(Processor& p, bool shouldBeBypassed)
+    {
+        for (size_t instance = 0; instance < Processor::maxInstances; ++instance)
+        {
+            for (size_t i = 0; i < Processor::numStages; ++i)
+            {
+                for (auto* param : p.GetParamsForOption(static_cast<Processor::DSP_Option>(i), instance))
+                {
+                    if (auto* bypass = dynamic_cast<juce::AudioParameterBool*>(param))
+                        *bypass = shouldBeBypassed;
+                }
+            }
+        }
+    }
+};
@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    BenchmarkHarness.cpp
+
+  ==============================================================================
+*/
+
+#include "BenchmarkHarness.h"
+
+juce::String BenchmarkResult::getId() const
+{
+    return suite + "/" + name + "/" + juce::String(juce::roundToInt(sampleRate)) + "/"
+         + juce::String(blockSize) + "/" + (bypassed ? "bypassed" : "active");
+}
+
+//==============================================================================
+void BenchmarkRunner::report(const BenchmarkResult& result) const
+{
+    std::cout << result.getId().paddedRight(' ', 56)
+              << juce::String(result.nsPerSample, 3).paddedLeft(' ', 12) << " ns/sample";
+
+    if (result.cyclesPerSample >= 0.0)
+        std::cout << juce::String(result.cyclesPerSample, 2).paddedLeft(' ', 12) << " cycles/sample";
+
+    std::cout << std::endl;
+}
+
+juce::var BenchmarkRunner::toJson() const
+{
+    auto meta = std::make_unique<juce::DynamicObject>();
+    meta->setProperty("cpu", juce::SystemStats::getCpuModel());
+    meta->setProperty("cpuMHz", juce::SystemStats::getCpuSpeedInMegahertz());
+    meta->setProperty("os", juce::SystemStats::getOperatingSystemName());
+    meta->setProperty("juce", juce::SystemStats::getJUCEVersion());
+    meta->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+    meta->setProperty("secondsPerCase", options.secondsPerCase);
+
+    juce::Array<juce::var> list;
+
+    for (const auto& r : results)
+    {
+        auto obj = std::make_unique<juce::DynamicObject>();
+        obj->setProperty("id", r.getId());
+        obj->setProperty("suite", r.suite);
+        obj->setProperty("name", r.name);
+        obj->setProperty("sampleRate", r.sampleRate);
+        obj->setProperty("blockSize", r.blockSize);
+        obj->setProperty("bypassed", r.bypassed);
+        obj->setProperty("nsPerSample", r.nsPerSample);
+        obj->setProperty("cyclesPerSample", r.cyclesPerSample);
+        obj->setProperty("numSamples", r.numSamples);
+        list.add(juce::var(obj.release()));
+    }
+
+    auto root = std::make_unique<juce::DynamicObject>();
+    root->setProperty("meta", juce::var(meta.release()));
+    root->setProperty("results", list);
+    return juce::var(root.release());
+}
+
+std::vector<BenchmarkResult> BenchmarkRunner::fromJson(const juce::var& json)
+{
+    std::vector<BenchmarkResult> parsed;
+
+    if (auto* list = json.getProperty("results", {}).getArray())
+    {
+        for (const auto& v : *list)
+        {
+            BenchmarkResult r;
+            r.suite = v.getProperty("suite", {}).toString();
+            r.name = v.getProperty("name", {}).toString();
+            r.sampleRate = v.getProperty("sampleRate", 0.0);
+            r.blockSize = v.getProperty("blockSize", 0);
+            r.bypassed = v.getProperty("bypassed", false);
+            r.nsPerSample = v.getProperty("nsPerSample", 0.0);
+            r.cyclesPerSample = v.getProperty("cyclesPerSample", -1.0);
+            r.numSamples = static_cast<juce::int64>(v.getProperty("numSamples", 0));
+            parsed.push_back(std::move(r));
+        }
+    }
+
+    return parsed;
+}
+
+std::vector<BenchmarkComparison> BenchmarkRunner::compare(const std::vector<BenchmarkResult>& baseline,
+                                                          const std::vector<BenchmarkResult>& current)
+{
+    std::map<juce::String, double> baselineById;
+
+    for (const auto& r : baseline)
+        baselineById[r.getId()] = r.nsPerSample;
+
+    std::vector<BenchmarkComparison> comparisons;
+
+    for (const auto& r : current)
+    {
+        auto it = baselineById.find(r.getId());
+
+        if (it != baselineById.end() && it->second > 0.0)
+            comparisons.push_back({ r.getId(), it->second, r.nsPerSample });
+    }
+
+    std::sort(comparisons.begin(), comparisons.end(), [](const auto& a, const auto& b)
+    {
+        return a.getChangePercent() > b.getChangePercent();
+    });
+
+    return comparisons;
+}
+
+//==============================================================================
+void fillWithNoise(juce::AudioBuffer<float>& buffer)
+{
+    juce::Random random(0x5eed);
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+    {
+        auto* data = buffer.getWritePointer(ch);
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            data[i] = (random.nextFloat() * 2.f - 1.f) * 0.5f;
+    }
+}
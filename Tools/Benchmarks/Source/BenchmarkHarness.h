@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    BenchmarkHarness.h
+    Timing loop, result table, json i/o and baseline comparison shared by all
+    benchmark suites.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+//==============================================================================
+/** Cycle counter used for cycles/sample, returns 0 where no counter is available. */
+inline juce::uint64 readCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return static_cast<juce::uint64>(__rdtsc());
+   #else
+    return 0;
+   #endif
+}
+
+//==============================================================================
+struct BenchmarkResult
+{
+    juce::String suite;     //"stage", "chain", ...
+    juce::String name;      //what was timed inside the suite
+    double sampleRate = 0.0;
+    int blockSize = 0;
+    bool bypassed = false;
+
+    double nsPerSample = 0.0;
+    double cyclesPerSample = -1.0; //-1 when the platform has no cycle counter
+    juce::int64 numSamples = 0;
+
+    /** suite/name/rate/block/bypass, used to match results against a baseline */
+    juce::String getId() const;
+};
+
+struct BenchmarkComparison
+{
+    juce::String id;
+    double baselineNsPerSample = 0.0;
+    double currentNsPerSample = 0.0;
+
+    double getChangePercent() const { return (currentNsPerSample / baselineNsPerSample - 1.0) * 100.0; }
+};
+
+//==============================================================================
+class BenchmarkRunner
+{
+public:
+    struct Options
+    {
+        double secondsPerCase = 0.02;
+        juce::String filter;        //only run cases whose suite/name contains this
+        std::vector<double> sampleRates{ 44100.0, 48000.0, 96000.0, 192000.0 };
+        std::vector<int> blockSizes{ 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+    };
+
+    explicit BenchmarkRunner(Options optionsToUse) : options(std::move(optionsToUse)) {}
+
+    const Options& getOptions() const { return options; }
+
+    bool wants(const juce::String& suite, const juce::String& name) const
+    {
+        return options.filter.isEmpty() || (suite + "/" + name).containsIgnoreCase(options.filter);
+    }
+
+    /** Calls processOneBlock() until secondsPerCase has elapsed and stores the per-sample cost.
+        The block size in 'result' is the number of samples each call processes.
+    */
+    template <typename ProcessOneBlock>
+    void measure(BenchmarkResult result, ProcessOneBlock&& processOneBlock)
+    {
+        juce::ScopedNoDenormals noDenormals;
+
+        //don't read the clock after every 1-sample block
+        const auto blocksPerCheck = juce::jmax(1, 256 / juce::jmax(1, result.blockSize));
+
+        for (int i = 0; i < warmupBlocks; ++i)
+            processOneBlock();
+
+        const auto budget = juce::Time::secondsToHighResolutionTicks(options.secondsPerCase);
+        juce::int64 numBlocks = 0;
+
+        const auto cyclesStart = readCycleCounter();
+        const auto start = juce::Time::getHighResolutionTicks();
+        auto now = start;
+
+        do
+        {
+            for (int i = 0; i < blocksPerCheck; ++i)
+                processOneBlock();
+
+            numBlocks += blocksPerCheck;
+            now = juce::Time::getHighResolutionTicks();
+        } while (now - start < budget);
+
+        const auto cycles = readCycleCounter() - cyclesStart;
+
+        result.numSamples = numBlocks * result.blockSize;
+        result.nsPerSample = juce::Time::highResolutionTicksToSeconds(now - start) * 1.0e9 / static_cast<double>(result.numSamples);
+        result.cyclesPerSample = cycles > 0 ? static_cast<double>(cycles) / static_cast<double>(result.numSamples) : -1.0;
+
+        report(result);
+        results.push_back(std::move(result));
+    }
+
+    const std::vector<BenchmarkResult>& getResults() const { return results; }
+
+    //==============================================================================
+    juce::var toJson() const;
+    static std::vector<BenchmarkResult> fromJson(const juce::var& json);
+
+    /** Every case present in both sets, slower ones first. */
+    static std::vector<BenchmarkComparison> compare(const std::vector<BenchmarkResult>& baseline,
+                                                    const std::vector<BenchmarkResult>& current);
+
+private:
+    void report(const BenchmarkResult& result) const;
+
+    static constexpr int warmupBlocks = 8;
+
+    Options options;
+    std::vector<BenchmarkResult> results;
+};
+
+//==============================================================================
+/** White noise at -6 dBFS, the same for every run. */
+void fillWithNoise(juce::AudioBuffer<float>& buffer);
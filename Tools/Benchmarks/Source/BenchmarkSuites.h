@@ -0,0 +1,30 @@
+/*
+  ==============================================================================
+
+    BenchmarkSuites.h
+    Entry points of the individual suites, Main.cpp runs them in this order.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BenchmarkHarness.h"
+
+/** Optional state applied to every processor a suite creates (a getStateInformation blob). */
+struct BenchmarkContext
+{
+    juce::MemoryBlock state;
+};
+
+/** Each DSP_Choice stage on its own, plus the full MultiChannelDSP::Process chain. */
+void runStageBenchmarks(BenchmarkRunner& runner, const BenchmarkContext& context);
+
+/** Per-tick control-rate work: smoother updates and UpdateDSPfromParams, static and automated; processBlock at every Control Rate. */
+void runControlRateBenchmarks(BenchmarkRunner& runner, const BenchmarkContext& context);
+
+/** One coefficient update, std vs ProjectAudio::FastMath, and the response error of the fast path. */
+void runCoefficientBenchmarks(BenchmarkRunner& runner, const BenchmarkContext& context);
+
+/** EnsembleChorus at every voice count against juce::dsp::Chorus, and the cost of one more voice. */
+void runChorusBenchmarks(BenchmarkRunner& runner, const BenchmarkContext& context);
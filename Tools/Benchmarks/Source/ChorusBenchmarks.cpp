@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    ChorusBenchmarks.cpp
+    ProjectAudio::EnsembleChorus at 1..8 voices against the stock
+    juce::dsp::Chorus, and the cost each extra voice adds.
+    Blocks are stereo and 64 samples, the sub-block size of processBlock.
+
+  ==============================================================================
+*/
+
+#include "BenchmarkSuites.h"
+#include "DSP/EnsembleChorus.h"
+
+void runChorusBenchmarks(BenchmarkRunner& runner, const BenchmarkContext&)
+{
+    constexpr int blockSize = 64;
+
+    for (auto sampleRate : runner.getOptions().sampleRates)
+    {
+        const juce::dsp::ProcessSpec spec{ sampleRate, static_cast<juce::uint32>(blockSize), 2 };
+
+        juce::AudioBuffer<float> source(2, blockSize), work(2, blockSize);
+        fillWithNoise(source);
+
+        auto block = juce::dsp::AudioBlock<float>(work);
+
+        BenchmarkResult config;
+        config.suite = "chorus";
+        config.sampleRate = sampleRate;
+        config.blockSize = blockSize;
+
+        if (runner.wants("chorus", "juce::dsp::Chorus"))
+        {
+            juce::dsp::Chorus<float> stockChorus;
+            stockChorus.prepare(spec);
+            stockChorus.setRate(0.5f);
+            stockChorus.setDepth(0.5f);
+            stockChorus.setCentreDelay(7.f);
+            stockChorus.setMix(0.5f);
+
+            config.name = "juce::dsp::Chorus";
+            runner.measure(config, [&]
+            {
+                work.makeCopyOf(source, true);
+                stockChorus.process(juce::dsp::ProcessContextReplacing<float>(block));
+            });
+        }
+
+        std::vector<double> nsPerVoiceCount;
+
+        for (size_t voices = 1; voices <= ProjectAudio::EnsembleChorus::maxVoices; ++voices)
+        {
+            const auto name = "EnsembleChorus/" + juce::String(voices) + (voices == 1 ? " voice" : " voices");
+
+            if (!runner.wants("chorus", name))
+                continue;
+
+            ProjectAudio::EnsembleChorus chorus;
+            chorus.prepare(spec);
+            chorus.setRate(0.5f);
+            chorus.setDepth(0.5f);
+            chorus.setCentreDelay(7.f);
+            chorus.setMix(0.5f);
+            chorus.setStereoSpread(1.f);
+            chorus.setNumVoices(voices);
+
+            config.name = name;
+            runner.measure(config, [&]
+            {
+                work.makeCopyOf(source, true);
+                chorus.process(juce::dsp::ProcessContextReplacing<float>(block));
+            });
+
+            nsPerVoiceCount.push_back(runner.getResults().back().nsPerSample);
+        }
+
+        //voices share lanes, so the cost grows in steps of one register of voices
+        if (nsPerVoiceCount.size() == ProjectAudio::EnsembleChorus::maxVoices)
+        {
+            const auto perVoice = (nsPerVoiceCount.back() - nsPerVoiceCount.front()) / static_cast<double>(nsPerVoiceCount.size() - 1);
+
+            std::cout << "chorus/cost per extra voice @ " << sampleRate << " Hz: "
+                      << juce::String(perVoice, 2) << " ns/sample" << std::endl;
+        }
+    }
+}
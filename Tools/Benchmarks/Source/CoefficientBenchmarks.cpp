@@ -0,0 +1,165 @@
+/*
+  ==============================================================================
+
+    CoefficientBenchmarks.cpp
+    Cost of one coefficient update, before and after ProjectAudio::FastMath,
+    and the worst frequency-response error the fast path introduces.
+    Block size is 1 here: ns/sample is the cost of one design / one call.
+
+  ==============================================================================
+*/
+
+#include "BenchmarkSuites.h"
+#include "DSP/ModulatedSVF.h"
+#include "DSP/FastMath.h"
+#include <complex>
+
+namespace
+{
+    constexpr size_t numInputs = 256;
+
+    struct DesignInputs
+    {
+        explicit DesignInputs(double sampleRate)
+        {
+            juce::Random random(0x5eed);
+
+            for (size_t i = 0; i < numInputs; ++i)
+            {
+                freqHz[i] = 20.f * std::pow(1000.f, random.nextFloat()); //20 Hz .. 20 kHz, log spaced
+                q[i] = 0.1f + 9.9f * random.nextFloat();
+                gainDb[i] = -24.f + 48.f * random.nextFloat();
+                response[i] = static_cast<ProjectAudio::SVFResponse>(random.nextInt(4));
+            }
+
+            invSampleRate = static_cast<float>(1.0 / sampleRate);
+        }
+
+        std::array<float, numInputs> freqHz, q, gainDb;
+        std::array<ProjectAudio::SVFResponse, numInputs> response;
+        float invSampleRate;
+    };
+
+    double getMagnitude(const ProjectAudio::SVFCoefficients& c, double normalisedFreq)
+    {
+        //bilinear-warped analog prototype of the TPT core
+        const auto s = std::complex<double>(0.0, std::tan(juce::MathConstants<double>::pi * normalisedFreq) / c.g);
+        const auto h = static_cast<double>(c.m0) + (static_cast<double>(c.m1) * s + static_cast<double>(c.m2))
+                                                   / (s * s + static_cast<double>(c.k) * s + 1.0);
+        return std::abs(h);
+    }
+
+    void reportResponseError(double sampleRate)
+    {
+        double worstDb = 0.0, worstAtHz = 0.0;
+
+        for (auto response : { ProjectAudio::SVFResponse::Peak, ProjectAudio::SVFResponse::Bandpass,
+                               ProjectAudio::SVFResponse::Notch, ProjectAudio::SVFResponse::Allpass })
+        {
+            for (int f = 0; f <= 100; ++f)
+            {
+                const auto freqHz = 20.f * std::pow(1000.f, static_cast<float>(f) / 100.f);
+
+                for (auto q : { 0.1f, 0.707f, 2.f, 10.f })
+                {
+                    for (auto gainDb : { -24.f, -6.f, 0.f, 6.f, 24.f })
+                    {
+                        const auto exact = ProjectAudio::SVFCoefficients::design(response, sampleRate, freqHz, q,
+                                                                                 juce::Decibels::decibelsToGain(gainDb));
+                        const auto fast = ProjectAudio::SVFCoefficients::design(response,
+                                                                                ProjectAudio::FastMath::tanPi(freqHz / static_cast<float>(sampleRate)),
+                                                                                q, ProjectAudio::FastMath::decibelsToGain(gainDb));
+
+                        for (int e = 0; e < 256; ++e)
+                        {
+                            const auto evalHz = 10.0 * std::pow(sampleRate * 0.049, e / 255.0); //10 Hz .. 0.49 fs
+                            const auto magExact = getMagnitude(exact, evalHz / sampleRate);
+
+                            if (magExact < 1.0e-3) //inside a notch, dB differences are meaningless
+                                continue;
+
+                            const auto errorDb = std::abs(juce::Decibels::gainToDecibels(getMagnitude(fast, evalHz / sampleRate), -200.0)
+                                                        - juce::Decibels::gainToDecibels(magExact, -200.0));
+
+                            if (errorDb > worstDb)
+                            {
+                                worstDb = errorDb;
+                                worstAtHz = evalHz;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        std::cout << "coeff/response error @ " << sampleRate << " Hz: worst " << juce::String(worstDb, 6)
+                  << " dB (at " << juce::String(worstAtHz, 1) << " Hz)" << std::endl;
+    }
+}
+
+void runCoefficientBenchmarks(BenchmarkRunner& runner, const BenchmarkContext&)
+{
+    for (auto sampleRate : runner.getOptions().sampleRates)
+    {
+        const DesignInputs in(sampleRate);
+        size_t i = 0;
+        volatile float sink = 0.f; //keeps the designs from being optimised away
+
+        auto next = [&i] { return i = (i + 1) % numInputs; };
+
+        BenchmarkResult config;
+        config.suite = "coeff";
+        config.sampleRate = sampleRate;
+        config.blockSize = 1;
+
+        auto run = [&](const char* name, auto&& oneUpdate)
+        {
+            if (!runner.wants("coeff", name))
+                return;
+
+            config.name = name;
+            runner.measure(config, oneUpdate);
+        };
+
+        run("general filter/IIR::Coefficients::make*", [&]
+        {
+            const auto n = next();
+            juce::dsp::IIR::Coefficients<float>::Ptr c;
+
+            switch (in.response[n])
+            {
+            case ProjectAudio::SVFResponse::Peak:     c = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, in.freqHz[n], in.q[n], juce::Decibels::decibelsToGain(in.gainDb[n])); break;
+            case ProjectAudio::SVFResponse::Bandpass: c = juce::dsp::IIR::Coefficients<float>::makeBandPass(sampleRate, in.freqHz[n], in.q[n]); break;
+            case ProjectAudio::SVFResponse::Notch:    c = juce::dsp::IIR::Coefficients<float>::makeNotch(sampleRate, in.freqHz[n], in.q[n]); break;
+            case ProjectAudio::SVFResponse::Allpass:  c = juce::dsp::IIR::Coefficients<float>::makeAllPass(sampleRate, in.freqHz[n], in.q[n]); break;
+            default: break;
+            }
+
+            sink = c->coefficients[0];
+        });
+
+        run("general filter/SVF std::tan", [&]
+        {
+            const auto n = next();
+            sink = ProjectAudio::SVFCoefficients::design(in.response[n], sampleRate, in.freqHz[n], in.q[n],
+                                                         juce::Decibels::decibelsToGain(in.gainDb[n])).g;
+        });
+
+        run("general filter/SVF FastMath", [&]
+        {
+            const auto n = next();
+            sink = ProjectAudio::SVFCoefficients::design(in.response[n],
+                                                         ProjectAudio::FastMath::tanPi(in.freqHz[n] * in.invSampleRate),
+                                                         in.q[n], ProjectAudio::FastMath::decibelsToGain(in.gainDb[n])).g;
+        });
+
+        run("decibelsToGain/juce", [&] { sink = juce::Decibels::decibelsToGain(in.gainDb[next()]); });
+        run("decibelsToGain/FastMath", [&] { sink = ProjectAudio::FastMath::decibelsToGain(in.gainDb[next()]); });
+
+        run("tan/std", [&] { sink = std::tan(juce::MathConstants<float>::pi * in.freqHz[next()] * in.invSampleRate); });
+        run("tan/FastMath::tanPi", [&] { sink = ProjectAudio::FastMath::tanPi(in.freqHz[next()] * in.invSampleRate); });
+
+        if (runner.wants("coeff", "response error"))
+            reportResponseError(sampleRate);
+    }
+}
@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    ControlRateBenchmarks.cpp
+    Cost of one 64-sample control tick: reading the parameters and advancing
+    the smoothers, then pushing the values into the stages.
+    "automated" moves every smoothed parameter each tick, "static" moves none.
+    "static, every setter" skips the dirty tracking, the cost of a tick when
+    every stage is pushed regardless.
+    "processBlock/<control rate>" runs whole 512-sample host blocks with every
+    smoothed parameter automated, once per Control Rate setting: the cost of
+    each step between per-sample updates and 128-sample ones.
+    ns/sample is the tick cost divided by the 64 samples it covers.
+
+  ==============================================================================
+*/
+
+#include "BenchmarkSuites.h"
+#include "BenchmarkAccess.h"
+#include "EffectRegistry.h"
+
+void runControlRateBenchmarks(BenchmarkRunner& runner, const BenchmarkContext& context)
+{
+    constexpr int tickSize = 64;
+
+    for (auto sampleRate : runner.getOptions().sampleRates)
+    {
+        auto processor = BenchmarkAccess::createPreparedProcessor(context.state, sampleRate, tickSize);
+        auto params = BenchmarkAccess::getSmoothedParams(*processor);
+
+        juce::Random random(0x5eed);
+
+        for (auto automated : { false, true })
+        {
+            auto moveParams = [&]
+            {
+                if (!automated)
+                    return;
+
+                for (juce::AudioProcessorParameter* param : params)
+                    param->setValue(random.nextFloat()); //no host notification, like automation arriving from the host
+            };
+
+            BenchmarkResult config;
+            config.suite = "control";
+            config.sampleRate = sampleRate;
+            config.blockSize = tickSize;
+
+            if (runner.wants("control", "UpdateSmoothersByParams"))
+            {
+                config.name = automated ? "UpdateSmoothersByParams/automated" : "UpdateSmoothersByParams/static";
+                runner.measure(config, [&]
+                {
+                    moveParams();
+                    BenchmarkAccess::updateSmoothers(*processor, tickSize);
+                });
+            }
+
+            if (runner.wants("control", "UpdateDSPfromParams"))
+            {
+                config.name = automated ? "UpdateDSPfromParams/automated" : "UpdateDSPfromParams/static";
+                runner.measure(config, [&]
+                {
+                    moveParams();
+                    BenchmarkAccess::updateSmoothers(*processor, tickSize);
+                    BenchmarkAccess::updateDSPfromParams(*processor);
+                });
+            }
+
+            if (!automated && runner.wants("control", "UpdateDSPfromParams"))
+            {
+                config.name = "UpdateDSPfromParams/static, every setter";
+                runner.measure(config, [&]
+                {
+                    BenchmarkAccess::updateSmoothers(*processor, tickSize);
+                    BenchmarkAccess::forceFullUpdate(*processor);
+                    BenchmarkAccess::updateDSPfromParams(*processor);
+                });
+            }
+        }
+
+        //the whole block at every control rate, parameters automated
+        constexpr int hostBlockSize = 512;
+        auto blockProcessor = BenchmarkAccess::createPreparedProcessor(context.state, sampleRate, hostBlockSize);
+        auto blockParams = BenchmarkAccess::getSmoothedParams(*blockProcessor);
+
+        juce::AudioBuffer<float> source(2, hostBlockSize), work(2, hostBlockSize);
+        fillWithNoise(source);
+        juce::MidiBuffer midi;
+
+        const auto& rates = ProjectAudio::EffectRegistry::Choices::controlRate;
+
+        for (size_t rate = 0; rate < rates.size(); ++rate)
+        {
+            const auto name = "processBlock/" + ProjectAudio::EffectRegistry::toString(rates[rate]);
+
+            if (!runner.wants("control", name))
+                continue;
+
+            BenchmarkAccess::setControlRate(*blockProcessor, static_cast<int>(rate));
+
+            BenchmarkResult config;
+            config.suite = "control";
+            config.name = name;
+            config.sampleRate = sampleRate;
+            config.blockSize = hostBlockSize;
+
+            runner.measure(config, [&]
+            {
+                for (juce::AudioProcessorParameter* param : blockParams)
+                    param->setValue(random.nextFloat());
+
+                work.makeCopyOf(source, true);
+                blockProcessor->processBlock(work, midi);
+            });
+        }
+    }
+}
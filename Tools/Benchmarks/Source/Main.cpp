@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    Benchmarks
+    Per-stage and whole-chain timings of ProjectAudioAudioProcessor.
+
+    Benchmarks [--out=results.json] [--baseline=baseline.json] [--threshold=10]
+               [--filter=phaser] [--quick] [--seconds=0.02] [--state=preset.bin]
+
+    --out        writes all results as json
+    --baseline   compares against an earlier --out file, cases slower by more than
+                 --threshold percent are listed and the exit code is 2
+    --filter     only runs cases whose "suite/name" contains the text
+    --quick      48 kHz only, block sizes 1/64/512/4096
+    --state      getStateInformation blob applied to every processor
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BenchmarkSuites.h"
+
+namespace
+{
+    juce::File getFileForOption(const juce::ArgumentList& args, const juce::String& option)
+    {
+        return juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption(option));
+    }
+
+    int compareWithBaseline(const BenchmarkRunner& runner, const juce::File& baselineFile, double thresholdPercent)
+    {
+        juce::var baselineJson;
+        auto parsed = juce::JSON::parse(baselineFile.loadFileAsString(), baselineJson);
+
+        if (parsed.failed())
+        {
+            std::cerr << baselineFile.getFileName() << ": " << parsed.getErrorMessage() << std::endl;
+            return 1;
+        }
+
+        auto comparisons = BenchmarkRunner::compare(BenchmarkRunner::fromJson(baselineJson), runner.getResults());
+        int numRegressions = 0;
+
+        std::cout << "\ncompared " << comparisons.size() << " cases with " << baselineFile.getFileName()
+                  << " (threshold " << thresholdPercent << "%)\n";
+
+        for (const auto& c : comparisons)
+        {
+            if (c.getChangePercent() <= thresholdPercent)
+                break; //sorted, slowest first
+
+            ++numRegressions;
+            std::cout << "REGRESSION  " << c.id.paddedRight(' ', 56)
+                      << juce::String(c.baselineNsPerSample, 3).paddedLeft(' ', 10) << " -> "
+                      << juce::String(c.currentNsPerSample, 3).paddedLeft(' ', 10) << " ns/sample  (+"
+                      << juce::String(c.getChangePercent(), 1) << "%)\n";
+        }
+
+        std::cout << numRegressions << " regression(s)" << std::endl;
+        return numRegressions > 0 ? 2 : 0;
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h"))
+    {
+        std::cout << "usage: Benchmarks [--out=results.json] [--baseline=baseline.json] [--threshold=10]\n"
+                     "                  [--filter=text] [--quick] [--seconds=0.02] [--state=preset.bin]\n";
+        return 0;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInit; //apvts needs a message manager
+
+    BenchmarkRunner::Options options;
+
+    if (args.containsOption("--quick"))
+    {
+        options.sampleRates = { 48000.0 };
+        options.blockSizes = { 1, 64, 512, 4096 };
+    }
+
+    if (args.containsOption("--seconds")) { options.secondsPerCase = args.getValueForOption("--seconds").getDoubleValue(); }
+    if (args.containsOption("--filter"))  { options.filter = args.getValueForOption("--filter"); }
+
+    BenchmarkContext context;
+
+    if (args.containsOption("--state") && !getFileForOption(args, "--state").loadFileAsData(context.state))
+    {
+        std::cerr << "Could not read " << args.getValueForOption("--state") << std::endl;
+        return 1;
+    }
+
+    BenchmarkRunner runner(options);
+
+    runStageBenchmarks(runner, context);
+    runControlRateBenchmarks(runner, context);
+    runCoefficientBenchmarks(runner, context);
+    runChorusBenchmarks(runner, context);
+
+    if (args.containsOption("--out"))
+    {
+        auto outFile = getFileForOption(args, "--out");
+
+        if (!outFile.replaceWithText(juce::JSON::toString(runner.toJson())))
+        {
+            std::cerr << "Could not write " << outFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+
+    if (args.containsOption("--baseline"))
+    {
+        auto threshold = args.containsOption("--threshold") ? args.getValueForOption("--threshold").getDoubleValue() : 10.0;
+        return compareWithBaseline(runner, getFileForOption(args, "--baseline"), threshold);
+    }
+
+    return 0;
+}
@@ -0,0 +1,349 @@
+/*
+  ==============================================================================
+
+    StageBenchmarks.cpp
+    Times every stage wrapped by DSP_Choice<T> on its own and the complete
+    MultiChannelDSP::Process chain, for every rate / block size, bypassed and not.
+    "ChainDSP::Process (filter, overdrive, filter 2)" runs three slots over two
+    instances, the per-slot dispatch used for orders outside the chain table.
+    "processBlock (chorus || phaser || ladderFilter, N workers)" is one split
+    of three branches mixed into the overdrive, through processBlock at the
+    saved Control Rate, with 0 up to 2 workers: each branch runs the whole host
+    block on one thread, blocks below ChainDSP::minParallelSamples stay on one.
+    "processBlock (pipelined, N stages)" cuts the requested order into N
+    stages, each a whole host block on its own worker; "1 stage" is the same
+    processBlock in series, the reference.
+    "processBlock (N bands, M workers)" runs the requested order on every
+    band of the crossover through processBlock, each band a whole host block
+    in one task, M from 0 up to N - 1 or the spare cores.
+    "processBlock (reordering)" requests a new order whenever the last switch
+    has ended, so nearly every block pays for the standby chain and the fade;
+    "processBlock" is the same processor with the order left alone.
+    Blocks are stereo, ns/sample is per sample frame (both channels).
+
+  ==============================================================================
+*/
+
+#include "BenchmarkSuites.h"
+#include "BenchmarkAccess.h"
+
+void runStageBenchmarks(BenchmarkRunner& runner, const BenchmarkContext& context)
+{
+    for (auto sampleRate : runner.getOptions().sampleRates)
+    {
+        for (auto blockSize : runner.getOptions().blockSizes)
+        {
+            auto processor = BenchmarkAccess::createPreparedProcessor(context.state, sampleRate, blockSize);
+            BenchmarkAccess::updateDSPfromParams(*processor);
+
+            //each call gets the same input, the copy is timed on its own as "stage/copy"
+            juce::AudioBuffer<float> source(2, blockSize), work(2, blockSize);
+            fillWithNoise(source);
+
+            auto block = juce::dsp::AudioBlock<float>(work);
+            auto refill = [&] { work.makeCopyOf(source, true); };
+
+            BenchmarkResult config;
+            config.sampleRate = sampleRate;
+            config.blockSize = blockSize;
+
+            if (runner.wants("stage", "copy"))
+            {
+                config.suite = "stage";
+                config.name = "copy";
+                runner.measure(config, refill);
+            }
+
+            for (auto bypassed : { false, true })
+            {
+                config.bypassed = bypassed;
+
+                for (auto& stage : BenchmarkAccess::getStages(*processor))
+                {
+                    if (!runner.wants("stage", stage.name))
+                        continue;
+
+                    config.suite = "stage";
+                    config.name = stage.name;
+
+                    stage.processor->reset();
+
+                    runner.measure(config, [&]
+                    {
+                        refill();
+                        auto processContext = juce::dsp::ProcessContextReplacing<float>(block);
+                        processContext.isBypassed = bypassed;
+                        stage.processor->process(processContext);
+                    });
+                }
+
+                //the LadderFilter pinned at 20 kHz that the overdrive stage used to be, for comparison
+                if (!bypassed && runner.wants("stage", "overdrive (LadderFilter reference)"))
+                {
+                    juce::dsp::LadderFilter<float> ladder;
+                    ladder.prepare({ sampleRate, static_cast<juce::uint32>(blockSize), 2 });
+                    ladder.setCutoffFrequencyHz(20000.f);
+                    ladder.setDrive(10.f);
+
+                    config.suite = "stage";
+                    config.name = "overdrive (LadderFilter reference)";
+
+                    runner.measure(config, [&]
+                    {
+                        refill();
+                        ladder.process(juce::dsp::ProcessContextReplacing<float>(block));
+                    });
+                }
+
+                //the stock phaser the phaser stage used to wrap, 6 stages like LanePhaser's default
+                if (!bypassed && runner.wants("stage", "phaser (juce::dsp::Phaser reference)"))
+                {
+                    juce::dsp::Phaser<float> stockPhaser;
+                    stockPhaser.prepare({ sampleRate, static_cast<juce::uint32>(blockSize), 2 });
+                    stockPhaser.setRate(0.2f);
+                    stockPhaser.setDepth(0.5f);
+                    stockPhaser.setCentreFrequency(800.f);
+                    stockPhaser.setMix(0.5f);
+
+                    config.suite = "stage";
+                    config.name = "phaser (juce::dsp::Phaser reference)";
+
+                    runner.measure(config, [&]
+                    {
+                        refill();
+                        stockPhaser.process(juce::dsp::ProcessContextReplacing<float>(block));
+                    });
+                }
+
+                //the stock ladder the ladderFilter stage used to wrap, at the default parameters
+                if (!bypassed && runner.wants("stage", "ladderFilter (juce::dsp::LadderFilter reference)"))
+                {
+                    juce::dsp::LadderFilter<float> stockLadder;
+                    stockLadder.prepare({ sampleRate, static_cast<juce::uint32>(blockSize), 2 });
+                    stockLadder.setMode(juce::dsp::LadderFilterMode::LPF12);
+                    stockLadder.setCutoffFrequencyHz(1000.f);
+                    stockLadder.setResonance(0.5f);
+
+                    config.suite = "stage";
+                    config.name = "ladderFilter (juce::dsp::LadderFilter reference)";
+
+                    runner.measure(config, [&]
+                    {
+                        refill();
+                        stockLadder.process(juce::dsp::ProcessContextReplacing<float>(block));
+                    });
+                }
+
+                if (runner.wants("chain", "MultiChannelDSP::Process"))
+                {
+                    config.suite = "chain";
+                    config.name = "MultiChannelDSP::Process";
+
+                    BenchmarkAccess::setAllBypassed(*processor, bypassed);
+
+                    runner.measure(config, [&]
+                    {
+                        refill();
+                        BenchmarkAccess::processChain(*processor, block);
+                    });
+
+                    BenchmarkAccess::setAllBypassed(*processor, false);
+                }
+
+                //the per-sub-block virtual dispatch that the chain table replaced
+                if (runner.wants("chain", "MultiChannelDSP::ProcessDynamic"))
+                {
+                    config.suite = "chain";
+                    config.name = "MultiChannelDSP::ProcessDynamic";
+
+                    BenchmarkAccess::setAllBypassed(*processor, bypassed);
+
+                    runner.measure(config, [&]
+                    {
+                        refill();
+                        BenchmarkAccess::processChainDynamic(*processor, block);
+                    });
+
+                    BenchmarkAccess::setAllBypassed(*processor, false);
+                }
+
+                //slots the inlined chains do not cover, a second instance behind the overdrive: one switch per slot
+                if (runner.wants("chain", "ChainDSP::Process (filter, overdrive, filter 2)"))
+                {
+                    config.suite = "chain";
+                    config.name = "ChainDSP::Process (filter, overdrive, filter 2)";
+
+                    using Option = BenchmarkAccess::Processor::DSP_Option;
+                    BenchmarkAccess::Processor::DSP_Order slots;
+                    slots[0] = { Option::GeneralFilter, 0 };
+                    slots[1] = { Option::Overdrive, 0 };
+                    slots[2] = { Option::GeneralFilter, 1 };
+
+                    BenchmarkAccess::copyInstance(*processor, 0, 1);
+                    BenchmarkAccess::setAllBypassed(*processor, bypassed);
+
+                    refill();
+                    BenchmarkAccess::processChain(*processor, block, slots); //wakes the second instance
+                    BenchmarkAccess::updateSmoothers(*processor, static_cast<int>(sampleRate)); //past the ramps to the copied values
+                    BenchmarkAccess::updateDSPfromParams(*processor);
+
+                    runner.measure(config, [&]
+                    {
+                        refill();
+                        BenchmarkAccess::processChain(*processor, block, slots);
+                    });
+
+                    BenchmarkAccess::setAllBypassed(*processor, false);
+                    BenchmarkAccess::processChain(*processor, block); //back to the requested order for the cases below
+                }
+
+                //three branches of one split on the worker pool against the same split on the calling thread alone,
+                //through processBlock so the branches get the host block and not one control interval
+                if (!bypassed)
+                {
+                    using Option = BenchmarkAccess::Processor::DSP_Option;
+                    using Route = BenchmarkAccess::Processor::DSP_Route;
+
+                    BenchmarkAccess::Processor::DSP_Order split;
+                    split[0] = { Option::Chorus, 0 };
+                    split[1] = { Option::Phase, 0, Route::Branch };
+                    split[2] = { Option::LadderFilter, 0, Route::Branch };
+                    split[3] = { Option::Overdrive, 0, Route::AfterMix };
+
+                    const auto requestedOrder = BenchmarkAccess::getRequestedOrder(*processor);
+                    const auto startWorkers = BenchmarkAccess::getWorkerThreads(*processor); //as the routing asked for them
+                    const auto maxWorkers = juce::jmin(2, BenchmarkAccess::getSpareCores()); //the caller runs the third branch
+                    juce::MidiBuffer midi;
+
+                    BenchmarkAccess::setOrder(*processor, split);
+
+                    for (int numWorkers = 0; numWorkers <= maxWorkers; ++numWorkers)
+                    {
+                        const auto name = "processBlock (chorus || phaser || ladderFilter, " + juce::String(numWorkers) + " workers)";
+
+                        if (!runner.wants("chain", name))
+                            continue;
+
+                        config.suite = "chain";
+                        config.name = name;
+
+                        BenchmarkAccess::setWorkerThreads(*processor, numWorkers, blockSize, sampleRate);
+
+                        refill();
+                        processor->processBlock(work, midi); //wakes the split's stages
+
+                        runner.measure(config, [&]
+                        {
+                            refill();
+                            processor->processBlock(work, midi);
+                        });
+                    }
+
+                    BenchmarkAccess::setWorkerThreads(*processor, startWorkers, blockSize, sampleRate);
+                    BenchmarkAccess::setOrder(*processor, requestedOrder); //back to the requested order for the cases below
+                }
+
+                //the requested order cut into stages that overlap across host blocks, against the same processBlock in series
+                if (!bypassed)
+                {
+                    const auto startWorkers = BenchmarkAccess::getWorkerThreads(*processor);
+                    juce::MidiBuffer midi;
+
+                    for (size_t depth = 1; depth <= BenchmarkAccess::maxPipelineDepth; ++depth)
+                    {
+                        const auto name = "processBlock (pipelined, " + juce::String(static_cast<int>(depth)) + (depth == 1 ? " stage)" : " stages)");
+
+                        if (!runner.wants("chain", name))
+                            continue;
+
+                        config.suite = "chain";
+                        config.name = name;
+
+                        BenchmarkAccess::setPipelineDepth(*processor, depth);
+                        BenchmarkAccess::setWorkerThreads(*processor, static_cast<int>(depth) - 1, blockSize, sampleRate); //as the timer would ask
+
+                        runner.measure(config, [&]
+                        {
+                            refill();
+                            processor->processBlock(work, midi);
+                        });
+                    }
+
+                    BenchmarkAccess::setPipelineDepth(*processor, 1);
+                    BenchmarkAccess::setWorkerThreads(*processor, startWorkers, blockSize, sampleRate);
+                }
+
+                //the whole order once per band: throughput against band count and every worker count that can help
+                if (!bypassed)
+                {
+                    const auto spareCores = BenchmarkAccess::getSpareCores();
+                    const auto startWorkers = BenchmarkAccess::getWorkerThreads(*processor);
+                    juce::MidiBuffer midi;
+
+                    for (size_t numBands = 2; numBands <= BenchmarkAccess::maxBands; ++numBands)
+                    {
+                        const auto maxWorkers = juce::jmin(static_cast<int>(numBands) - 1, spareCores); //the caller runs a band too
+
+                        for (int numWorkers = 0; numWorkers <= maxWorkers; ++numWorkers)
+                        {
+                            const auto name = "processBlock (" + juce::String(static_cast<int>(numBands)) + " bands, "
+                                              + juce::String(numWorkers) + " workers)";
+
+                            if (!runner.wants("chain", name))
+                                continue;
+
+                            config.suite = "chain";
+                            config.name = name;
+
+                            BenchmarkAccess::setWorkerThreads(*processor, numWorkers, blockSize, sampleRate);
+                            BenchmarkAccess::setNumBands(*processor, numBands); //wakes every band's stages
+
+                            refill();
+                            processor->processBlock(work, midi); //past the restart a new band count causes
+
+                            runner.measure(config, [&]
+                            {
+                                refill();
+                                processor->processBlock(work, midi);
+                            });
+                        }
+                    }
+
+                    BenchmarkAccess::setNumBands(*processor, 1);
+                    BenchmarkAccess::setWorkerThreads(*processor, startWorkers, blockSize, sampleRate);
+                }
+
+                //live reorders: two chains and the crossfade against the steady chain
+                if (!bypassed)
+                {
+                    juce::MidiBuffer midi;
+
+                    for (auto reorder : { false, true })
+                    {
+                        const juce::String name = reorder ? "processBlock (reordering)" : "processBlock";
+
+                        if (!runner.wants("chain", name))
+                            continue;
+
+                        config.suite = "chain";
+                        config.name = name;
+
+                        runner.measure(config, [&]
+                        {
+                            if (reorder && !BenchmarkAccess::isReordering(*processor))
+                            {
+                                auto order = BenchmarkAccess::getRequestedOrder(*processor);
+                                const auto end = std::find(order.begin(), order.end(), BenchmarkAccess::Processor::DSP_Slot{}); //first empty slot
+                                std::rotate(order.begin(), order.begin() + 1, end);
+                                BenchmarkAccess::requestOrder(*processor, order);
+                            }
+
+                            refill();
+                            processor->processBlock(work, midi);
+                        });
+                    }
+                }
+            }
+        }
+    }
+}
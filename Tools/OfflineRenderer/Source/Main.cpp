@@ -0,0 +1,325 @@
+/*
+  ==============================================================================
+
+    OfflineRenderer
+    Runs ProjectAudioAudioProcessor over an audio file outside a DAW.
+
+    OfflineRenderer --in=dry.wav --out=wet.wav [--state=preset.bin] [--config=chain.json]
+                    [--block=512] [--buffers=32] [--bits=24] [--tail=seconds]
+                    [--rt-stress] [--rt-abort]
+
+    --state   a blob saved by getStateInformation(), loaded with setStateInformation()
+    --config  json applied on top of the state:
+              {
+                "order": [ "CHORUS", "PHASER", { "effect": "CHORUS", "instance": 2, "route": "BRANCH", "band": 1 } ],
+                "parameters": { "Phaser RateHz": 0.5, "Chorus Bypass": 1 }
+              }
+              "order" lists 1 - 10 slots, each an effect name or an object with an
+              optional instance (1 - 2, like the parameter IDs), route (SERIES, BRANCH,
+              AFTERMIX) and band (0: every band, 1 - 4); every instance at most once
+              parameter values are given in their real range (Hz, %, choice index ...)
+    --rt-stress  between blocks: automates random parameters, pushes random orders
+                 (1 - 10 slots of either instance, random routes and bands) through
+                 dsporderFifo, moves the pipeline stages, bands and reorder crossfade,
+                 runs the processor's timer like a message thread would (latency, FIR
+                 designs, worker demand) and round-trips get/setStateInformation.
+                 Every 32 blocks a ten-branch split runs on four bands for 8 blocks,
+                 with pauses the workers fall asleep in, so the audio thread wakes them.
+                 Built as the RealtimeCheck configuration (PROJECTAUDIO_RT_SAFETY_CHECKS=1)
+                 every allocation, lock or blocking syscall inside processBlock is
+                 reported with a stack trace and the exit code is 3.
+    --rt-abort   abort on the first violation instead (for a debugger / core dump)
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "RenderPipeline.h"
+#include "Debug/RealtimeSafety.h"
+
+namespace
+{
+    using Processor = ProjectAudioAudioProcessor;
+    using DSP_Option = Processor::DSP_Option;
+    using DSP_Route = Processor::DSP_Route;
+    using DSP_Band = Processor::DSP_Band;
+    using DSP_Slot = Processor::DSP_Slot;
+
+    DSP_Option getDspOptionFromName(const juce::String& name) //same names as the editor tabs
+    {
+        if (name.equalsIgnoreCase("PHASER")) { return DSP_Option::Phase; }
+        if (name.equalsIgnoreCase("CHORUS")) { return DSP_Option::Chorus; }
+        if (name.equalsIgnoreCase("OVERDRIVE")) { return DSP_Option::Overdrive; }
+        if (name.equalsIgnoreCase("LADDERFILTER")) { return DSP_Option::LadderFilter; }
+        if (name.equalsIgnoreCase("GENERALFILTER")) { return DSP_Option::GeneralFilter; }
+        return DSP_Option::END_OF_LIST;
+    }
+
+    DSP_Route getDspRouteFromName(const juce::String& name) //same choices as the editor's tab menu
+    {
+        if (name.equalsIgnoreCase("SERIES")) { return DSP_Route::Series; }
+        if (name.equalsIgnoreCase("BRANCH")) { return DSP_Route::Branch; }
+        if (name.equalsIgnoreCase("AFTERMIX")) { return DSP_Route::AfterMix; }
+        return DSP_Route::END_OF_LIST;
+    }
+
+    /** One "order" entry: "CHORUS" or { "effect": "CHORUS", "instance": 2, "route": "BRANCH", "band": 1 }. */
+    juce::Result parseSlot(const juce::var& entry, DSP_Slot& slot)
+    {
+        const auto* object = entry.getDynamicObject();
+        const auto name = object != nullptr ? object->getProperty("effect").toString() : entry.toString();
+
+        slot = {};
+        slot.option = getDspOptionFromName(name);
+
+        if (slot.option == DSP_Option::END_OF_LIST)
+            return juce::Result::fail("Unknown effect in \"order\": " + name);
+
+        if (object == nullptr)
+            return juce::Result::ok();
+
+        const auto instance = object->hasProperty("instance") ? static_cast<int>(object->getProperty("instance")) : 1;
+
+        if (instance < 1 || instance > static_cast<int>(Processor::maxInstances))
+            return juce::Result::fail(name + ": \"instance\" must be 1 - " + juce::String(Processor::maxInstances));
+
+        slot.instance = static_cast<size_t>(instance - 1);
+
+        if (object->hasProperty("route"))
+        {
+            slot.route = getDspRouteFromName(object->getProperty("route").toString());
+
+            if (slot.route == DSP_Route::END_OF_LIST)
+                return juce::Result::fail(name + ": unknown \"route\" " + object->getProperty("route").toString());
+        }
+
+        const auto band = object->hasProperty("band") ? static_cast<int>(object->getProperty("band")) : 0;
+
+        if (band < 0 || band >= static_cast<int>(DSP_Band::END_OF_LIST))
+            return juce::Result::fail(name + ": \"band\" must be 0 - " + juce::String(static_cast<int>(DSP_Band::END_OF_LIST) - 1));
+
+        slot.band = static_cast<DSP_Band>(band);
+        return juce::Result::ok();
+    }
+
+    juce::Result loadState(ProjectAudioAudioProcessor& processor, const juce::File& file)
+    {
+        juce::MemoryBlock data;
+
+        if (!file.loadFileAsData(data) || data.isEmpty())
+            return juce::Result::fail("Could not read state " + file.getFullPathName());
+
+        processor.setStateInformation(data.getData(), static_cast<int>(data.getSize()));
+        return juce::Result::ok();
+    }
+
+    juce::Result applyConfig(ProjectAudioAudioProcessor& processor, const juce::File& file)
+    {
+        juce::var config;
+        auto parsed = juce::JSON::parse(file.loadFileAsString(), config);
+
+        if (parsed.failed())
+            return juce::Result::fail(file.getFileName() + ": " + parsed.getErrorMessage());
+
+        if (auto* order = config.getProperty("order", {}).getArray())
+        {
+            Processor::DSP_Order newOrder; //the slots after the listed ones stay empty
+
+            if (order->isEmpty() || static_cast<size_t>(order->size()) > newOrder.size())
+                return juce::Result::fail("\"order\" needs 1 - " + juce::String(newOrder.size()) + " entries");
+
+            for (size_t i = 0; i < static_cast<size_t>(order->size()); ++i)
+            {
+                auto slotResult = parseSlot(order->getReference(static_cast<int>(i)), newOrder[i]);
+
+                if (slotResult.failed())
+                    return slotResult;
+
+                const auto end = newOrder.begin() + static_cast<std::ptrdiff_t>(i);
+
+                if (std::find_if(newOrder.begin(), end, [&](const DSP_Slot& s) { return s.RunsSameStage(newOrder[i]); }) != end)
+                    return juce::Result::fail("\"order\" entry " + juce::String(i + 1) + " repeats an instance listed before it");
+            }
+
+            processor.dsporderFifo.push(newOrder);
+        }
+
+        if (auto* params = config.getProperty("parameters", {}).getDynamicObject())
+        {
+            for (auto& p : params->getProperties())
+            {
+                auto* param = processor.apvts.getParameter(p.name.toString());
+
+                if (param == nullptr)
+                    return juce::Result::fail("Unknown parameter: " + p.name.toString());
+
+                param->setValueNotifyingHost(param->convertTo0to1(static_cast<float>(p.value)));
+            }
+        }
+
+        return juce::Result::ok();
+    }
+
+    /** 1 - 10 of the valid slots in random order, each with a random route and band, the rest empty. */
+    Processor::DSP_Order makeRandomOrder(juce::Random& random)
+    {
+        Processor::DSP_Order order;
+
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = DSP_Slot{ static_cast<DSP_Option>(i % Processor::numStages), i / Processor::numStages };
+
+        for (auto i = static_cast<int>(order.size()) - 1; i > 0; --i)
+            std::swap(order[static_cast<size_t>(i)], order[static_cast<size_t>(random.nextInt(i + 1))]);
+
+        const auto numSlots = static_cast<size_t>(1 + random.nextInt(static_cast<int>(order.size())));
+
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            if (i >= numSlots)
+            {
+                order[i] = {};
+                continue;
+            }
+
+            order[i].route = static_cast<DSP_Route>(random.nextInt(static_cast<int>(DSP_Route::END_OF_LIST)));
+            order[i].band = static_cast<DSP_Band>(random.nextInt(static_cast<int>(DSP_Band::END_OF_LIST)));
+        }
+
+        return order;
+    }
+
+    /** Every slot its own branch of one split, the widest fan-out the workers get. */
+    Processor::DSP_Order makeSplitOrder()
+    {
+        Processor::DSP_Order order;
+
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = DSP_Slot{ static_cast<DSP_Option>(i % Processor::numStages), i / Processor::numStages, DSP_Route::Branch };
+
+        return order;
+    }
+
+    /** Hammers everything the audio thread reacts to, from the thread that calls processBlock. */
+    std::function<void(juce::int64)> makeStressHook(ProjectAudioAudioProcessor& processor)
+    {
+        return [&processor, random = juce::Random(0x5eed)](juce::int64 block) mutable
+        {
+            auto& params = processor.getParameters();
+
+            for (int i = 0; i < 4; ++i)
+                params[random.nextInt(params.size())]->setValueNotifyingHost(random.nextFloat());
+
+            const auto splitPhase = block % 32 >= 16 && block % 32 < 24; //sleeping workers, woken by the audio thread for the branches of every band
+
+            if (block % 8 == 0)
+                processor.dsporderFifo.push(splitPhase ? makeSplitOrder() : makeRandomOrder(random));
+
+            if (block % 16 == 4) //the engine settings the slots run under, a crossfade often still running when the next order comes
+            {
+                for (auto* id : { "Pipeline Stages", "Bands", "Reorder Crossfade Ms" })
+                    processor.apvts.getParameter(id)->setValueNotifyingHost(random.nextFloat());
+            }
+
+            if (splitPhase)
+            {
+                processor.apvts.getParameter("Bands")->setValueNotifyingHost(1.0f);
+
+                if (block % 2 == 1)
+                    juce::Thread::sleep(1); //longer than the workers spin, so the next split finds them asleep
+            }
+
+            //no message loop runs here: latency, FIR designs and the worker pool's demand follow the audio thread like in a host
+            juce::Timer::callPendingTimersSynchronously();
+
+            if (block % 64 == 32)
+            {
+                juce::MemoryBlock state;
+                processor.getStateInformation(state);
+                processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+            }
+        };
+    }
+
+    void printUsage()
+    {
+        std::cout << "usage: OfflineRenderer --in=<file> --out=<file.wav> [--state=<file>] [--config=<file.json>]\n"
+                     "                       [--block=512] [--buffers=32] [--bits=24] [--tail=<seconds>]\n"
+                     "                       [--rt-stress] [--rt-abort]\n";
+    }
+}
+
+//==============================================================================
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    if (args.containsOption("--help|-h") || !args.containsOption("--in") || !args.containsOption("--out"))
+    {
+        printUsage();
+        return args.containsOption("--help|-h") ? 0 : 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInit; //apvts needs a message manager
+
+    RenderSettings settings;
+    settings.inputFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--in"));
+    settings.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--out"));
+
+    if (args.containsOption("--block"))   { settings.blockSize = args.getValueForOption("--block").getIntValue(); }
+    if (args.containsOption("--buffers")) { settings.numBufferedBlocks = args.getValueForOption("--buffers").getIntValue(); }
+    if (args.containsOption("--bits"))    { settings.bitsPerSample = args.getValueForOption("--bits").getIntValue(); }
+    if (args.containsOption("--tail"))    { settings.tailSeconds = args.getValueForOption("--tail").getDoubleValue(); }
+
+    auto processor = std::make_unique<ProjectAudioAudioProcessor>();
+
+    auto result = juce::Result::ok();
+
+    if (args.containsOption("--state"))
+        result = loadState(*processor, juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--state")));
+
+    if (result.wasOk() && args.containsOption("--config"))
+        result = applyConfig(*processor, juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--config")));
+
+    if (args.containsOption("--rt-stress"))
+        settings.beforeEachBlock = makeStressHook(*processor);
+
+   #if PROJECTAUDIO_RT_SAFETY_CHECKS
+    if (args.containsOption("--rt-abort"))
+        ProjectAudio::RealtimeSafety::setAction(ProjectAudio::RealtimeSafety::Action::abort);
+   #else
+    if (args.containsOption("--rt-stress|--rt-abort"))
+        std::cerr << "note: built without PROJECTAUDIO_RT_SAFETY_CHECKS, violations are not trapped" << std::endl;
+   #endif
+
+    RenderStats stats;
+
+    if (result.wasOk())
+    {
+        RenderPipeline pipeline(*processor, settings);
+        result = pipeline.run(stats);
+    }
+
+    if (result.failed())
+    {
+        std::cerr << result.getErrorMessage() << std::endl;
+        return 1;
+    }
+
+    std::cout << "rendered     " << stats.numSamples << " samples x " << stats.numChannels << " ch @ "
+              << stats.sampleRate << " Hz (block " << settings.blockSize << ")\n"
+              << "audio        " << stats.getAudioSeconds() << " s\n"
+              << "dsp          " << stats.dspSeconds << " s, " << stats.getRealtimeFactor() << "x realtime\n"
+              << "wall         " << stats.wallSeconds << " s, " << stats.getWallRealtimeFactor() << "x realtime\n"
+              << "throughput   " << stats.getSamplesPerSecond() << " samples/s" << std::endl;
+
+   #if PROJECTAUDIO_RT_SAFETY_CHECKS
+    if (auto numViolations = ProjectAudio::RealtimeSafety::getNumViolations(); numViolations > 0)
+    {
+        std::cerr << numViolations << " realtime safety violation(s) inside processBlock" << std::endl;
+        return 3;
+    }
+   #endif
+
+    return 0;
+}
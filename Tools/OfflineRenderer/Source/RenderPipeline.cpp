@@ -0,0 +1,219 @@
+/*
+  ==============================================================================
+
+    RenderPipeline.cpp
+
+  ==============================================================================
+*/
+
+#include "RenderPipeline.h"
+#include <thread>
+
+namespace
+{
+    /*
+     Ring of preallocated blocks. Each stage owns a monotonically increasing cursor,
+     block n lives in slot n % size:
+
+       written <= processed <= decoded <= written + size
+    */
+    struct BlockRing
+    {
+        BlockRing(int numSlots, int numChannels, int blockSize)
+        {
+            slots.resize(static_cast<size_t>(numSlots));
+            for (auto& s : slots)
+                s.setSize(numChannels, blockSize);
+
+            lengths.resize(static_cast<size_t>(numSlots), 0);
+        }
+
+        juce::int64 size() const { return static_cast<juce::int64>(slots.size()); }
+        juce::AudioBuffer<float>& slot(juce::int64 block) { return slots[static_cast<size_t>(block % size())]; }
+        int& length(juce::int64 block) { return lengths[static_cast<size_t>(block % size())]; }
+
+        std::vector<juce::AudioBuffer<float>> slots;
+        std::vector<int> lengths;
+
+        std::atomic<juce::int64> decoded{ 0 }, processed{ 0 }, written{ 0 };
+        std::atomic<bool> readerFinished{ false }, dspFinished{ false }, aborted{ false };
+
+        juce::WaitableEvent blockDecoded, blockProcessed, blockWritten;
+    };
+
+    constexpr int waitTimeoutMs = 5;
+}
+
+//==============================================================================
+RenderPipeline::RenderPipeline(juce::AudioProcessor& processorToUse, RenderSettings settingsToUse) :
+    processor(processorToUse),
+    settings(std::move(settingsToUse))
+{
+    formatManager.registerBasicFormats();
+}
+
+juce::Result RenderPipeline::run(RenderStats& stats)
+{
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(settings.inputFile));
+
+    if (reader == nullptr)
+        return juce::Result::fail("Could not open " + settings.inputFile.getFullPathName());
+
+    const auto sampleRate = reader->sampleRate;
+    const auto blockSize = juce::jmax(1, settings.blockSize);
+    const auto numInputs = processor.getTotalNumInputChannels();
+    const auto numOutputs = processor.getTotalNumOutputChannels();
+    const auto numChannels = juce::jmax(numInputs, numOutputs);
+
+    //**prepare the processor exactly like a host would **//
+    processor.setNonRealtime(true);
+    processor.setPlayConfigDetails(numInputs, numOutputs, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    const auto tailSeconds = settings.tailSeconds >= 0.0 ? settings.tailSeconds
+                                                         : processor.getTailLengthSeconds();
+    const auto fileLength = reader->lengthInSamples;
+    const auto totalLength = fileLength + static_cast<juce::int64>(tailSeconds * sampleRate);
+
+    //**the writer owns the stream once it has been created **//
+    settings.outputFile.deleteFile();
+    auto outStream = settings.outputFile.createOutputStream();
+
+    if (outStream == nullptr)
+        return juce::Result::fail("Could not write " + settings.outputFile.getFullPathName());
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatWriter> writer(wav.createWriterFor(outStream.get(), sampleRate,
+                                                                        static_cast<unsigned int>(numOutputs),
+                                                                        settings.bitsPerSample, {}, 0));
+    if (writer == nullptr)
+        return juce::Result::fail("Unsupported output format (" + juce::String(settings.bitsPerSample) + " bit)");
+
+    outStream.release();
+
+    BlockRing ring(juce::jmax(2, settings.numBufferedBlocks), numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    const auto wallStart = juce::Time::getHighResolutionTicks();
+
+    //==============================================================================
+    std::thread readerThread([&]
+    {
+        juce::int64 position = 0;
+
+        for (juce::int64 block = 0; position < totalLength && !ring.aborted; ++block)
+        {
+            while (block - ring.written.load() >= ring.size()) //ring full, wait for the writer
+            {
+                if (ring.aborted)
+                    return;
+
+                ring.blockWritten.wait(waitTimeoutMs);
+            }
+
+            auto& buffer = ring.slot(block);
+            const auto numSamples = static_cast<int>(juce::jmin<juce::int64>(blockSize, totalLength - position));
+
+            buffer.clear();
+
+            if (position < fileLength) //past the end of the file we keep feeding silence for the tail
+            {
+                const auto numFromFile = static_cast<int>(juce::jmin<juce::int64>(numSamples, fileLength - position));
+                reader->read(&buffer, 0, numFromFile, position, true, true);
+            }
+
+            ring.length(block) = numSamples;
+            position += numSamples;
+
+            ring.decoded.store(block + 1);
+            ring.blockDecoded.signal();
+        }
+
+        ring.readerFinished = true;
+        ring.blockDecoded.signal();
+    });
+
+    //==============================================================================
+    std::atomic<bool> writeFailed{ false };
+
+    std::thread writerThread([&]
+    {
+        for (juce::int64 block = 0;; ++block)
+        {
+            while (block >= ring.processed.load())
+            {
+                if ((ring.dspFinished && block >= ring.processed.load()) || ring.aborted)
+                    return;
+
+                ring.blockProcessed.wait(waitTimeoutMs);
+            }
+
+            if (!writer->writeFromAudioSampleBuffer(ring.slot(block), 0, ring.length(block)))
+            {
+                writeFailed = true;
+                ring.aborted = true;
+                return;
+            }
+
+            ring.written.store(block + 1);
+            ring.blockWritten.signal();
+        }
+    });
+
+    //==============================================================================
+    juce::int64 dspTicks = 0;
+    juce::int64 samplesProcessed = 0;
+
+    for (juce::int64 block = 0; !ring.aborted; ++block)
+    {
+        while (block >= ring.decoded.load())
+        {
+            if (ring.readerFinished && block >= ring.decoded.load())
+                break;
+
+            ring.blockDecoded.wait(waitTimeoutMs);
+        }
+
+        if (block >= ring.decoded.load())
+            break;
+
+        auto& slot = ring.slot(block);
+        const auto numSamples = ring.length(block);
+
+        //refer to the slot's channels, no allocation for a short last block
+        juce::AudioBuffer<float> buffer(slot.getArrayOfWritePointers(), slot.getNumChannels(), numSamples);
+
+        if (settings.beforeEachBlock)
+            settings.beforeEachBlock(block);
+
+        const auto start = juce::Time::getHighResolutionTicks();
+        processor.processBlock(buffer, midi);
+        dspTicks += juce::Time::getHighResolutionTicks() - start;
+
+        midi.clear();
+        samplesProcessed += numSamples;
+
+        ring.processed.store(block + 1);
+        ring.blockProcessed.signal();
+    }
+
+    ring.dspFinished = true;
+    ring.blockProcessed.signal();
+
+    readerThread.join();
+    writerThread.join();
+
+    writer.reset(); //flushes the header
+    processor.releaseResources();
+
+    if (writeFailed)
+        return juce::Result::fail("Write error on " + settings.outputFile.getFullPathName());
+
+    stats.numSamples = samplesProcessed;
+    stats.numChannels = numOutputs;
+    stats.sampleRate = sampleRate;
+    stats.dspSeconds = juce::Time::highResolutionTicksToSeconds(dspTicks);
+    stats.wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - wallStart);
+
+    return juce::Result::ok();
+}
@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    RenderPipeline.h
+    Streams an audio file through an AudioProcessor without a host.
+
+    Three stages run at once:
+      reader thread -> decodes blocks ahead into a ring of preallocated buffers
+      calling thread -> runs processBlock on each block, in order
+      writer thread -> encodes processed blocks behind the dsp loop
+
+    The dsp loop only waits when the reader has fallen behind, disk I/O never
+    happens on the thread that calls processBlock.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+struct RenderSettings
+{
+    juce::File inputFile;
+    juce::File outputFile;
+
+    int blockSize = 512;        //samples handed to processBlock per call
+    int numBufferedBlocks = 32; //ring size shared by reader/dsp/writer
+    int bitsPerSample = 24;
+    double tailSeconds = -1.0;  //silence rendered after the input, < 0 asks the processor
+
+    /** Runs on the dsp thread before each processBlock call, outside the timed section.
+        Used by --rt-stress to change parameters, order and state between blocks. */
+    std::function<void(juce::int64 blockIndex)> beforeEachBlock;
+};
+
+struct RenderStats
+{
+    juce::int64 numSamples = 0;  //per channel, including the rendered tail
+    int numChannels = 0;
+    double sampleRate = 0.0;
+
+    double dspSeconds = 0.0;     //time spent inside processBlock only
+    double wallSeconds = 0.0;    //reader start -> writer finished
+
+    double getAudioSeconds() const { return sampleRate > 0.0 ? numSamples / sampleRate : 0.0; }
+    double getRealtimeFactor() const { return dspSeconds > 0.0 ? getAudioSeconds() / dspSeconds : 0.0; }
+    double getWallRealtimeFactor() const { return wallSeconds > 0.0 ? getAudioSeconds() / wallSeconds : 0.0; }
+    double getSamplesPerSecond() const { return dspSeconds > 0.0 ? numSamples / dspSeconds : 0.0; }
+};
+
+class RenderPipeline
+{
+public:
+    RenderPipeline(juce::AudioProcessor& processorToUse, RenderSettings settingsToUse);
+
+    /** Prepares the processor for the input file, renders it and releases the processor again. */
+    juce::Result run(RenderStats& stats);
+
+private:
+    juce::AudioProcessor& processor;
+    RenderSettings settings;
+    juce::AudioFormatManager formatManager;
+
+    JUCE_DECLARE_NON_COPYABLE(RenderPipeline)
+};